@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+
+#include <entt/entt.hpp>
+
+// Announces that a component was updated for many entities at once
+// Systems which update a component in bulk write to it directly and publish the entities here, 
+//  instead of calling patch for every entity and firing every on_update listener once per entity
+// Lives in the registry context, use BatchedUpdate<Component>::get to fetch or create it
+template<typename Component>
+class BatchedUpdate {
+public:
+    static BatchedUpdate<Component>& get(entt::registry& registry) {
+        // Emplacing into the context returns the existing value if there is one
+        return registry.ctx().emplace<BatchedUpdate<Component>>();
+    }
+
+    void publish(const std::vector<entt::entity>& entities) {
+        if (!entities.empty()) {
+            this->updated.publish(entities);
+        }
+    }
+
+    template<auto Func, typename Instance>
+    void connect(Instance instance) {
+        entt::sink sink{this->updated};
+        sink.template connect<Func>(instance);
+    }
+
+    template<auto Func, typename Instance>
+    void disconnect(Instance instance) {
+        entt::sink sink{this->updated};
+        sink.template disconnect<Func>(instance);
+    }
+
+private:
+    entt::sigh<void(const std::vector<entt::entity>&)> updated;
+};
+
+// Collects entities from the batched updates of a component which have all of the Where components,
+//  the batched counterpart of an observer on update<Component>().where<Where...>()
+template<typename Component, typename... Where>
+class BatchedObserver {
+public:
+    BatchedObserver(entt::registry& registry) : registry{registry} {
+        this->connect();
+    }
+
+    ~BatchedObserver() {
+        this->disconnect();
+    }
+
+    BatchedObserver(const BatchedObserver&) = delete;
+    BatchedObserver& operator=(const BatchedObserver&) = delete;
+
+    void connect() {
+        BatchedUpdate<Component>::get(this->registry).template connect<&BatchedObserver::receive>(this);
+    }
+
+    void disconnect() {
+        BatchedUpdate<Component>::get(this->registry).template disconnect<&BatchedObserver::receive>(this);
+        this->entities.clear();
+    }
+
+    // Calls func for every collected entity which still matches, then clears the collected entities
+    template<typename Func>
+    void each(Func func) {
+        for (auto entity : this->entities) {
+            if (this->registry.valid(entity) && this->registry.template all_of<Where...>(entity)) {
+                func(entity);
+            }
+        }
+        this->entities.clear();
+    }
+
+    void clear() {
+        this->entities.clear();
+    }
+
+private:
+    void receive(const std::vector<entt::entity>& updated_entities) {
+        this->entities.insert(this->entities.end(), updated_entities.begin(), updated_entities.end());
+    }
+
+    entt::registry& registry;
+    std::vector<entt::entity> entities;
+};
\ No newline at end of file
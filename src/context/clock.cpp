@@ -11,7 +11,11 @@ double Clock::tick() {
     last_frame = current_frame;
     current_frame = SDL_GetPerformanceCounter();
 
-    delta_time = (double)((current_frame - last_frame) / (double)SDL_GetPerformanceFrequency() *1000);
+    if (this->fixed_frame_time > 0) {
+        delta_time = this->fixed_frame_time;
+    } else {
+        delta_time = (double)((current_frame - last_frame) / (double)SDL_GetPerformanceFrequency() *1000);
+    }
     cumulative_time += delta_time;
 
     this->fps = 1.0/delta_time * 1000;
@@ -20,11 +24,45 @@ double Clock::tick() {
 
     this->smoothed_fps = (smoothed_fps * smoothing) + (this->fps * (1 - smoothing));
 
+    // Clamp the accumulated time so that slow frames do not cause ever more simulation steps
+    //  The simulation slows down instead
+    this->accumulator = std::min(
+        this->accumulator + delta_time, 
+        globals::SIMULATION_TIME_STEP*globals::MAX_SIMULATION_STEPS_PER_FRAME
+    );
+    this->frame_simulation_steps = 0;
+
     return delta_time;
 }
 
-// Returns the time change since the last tick in milliseconds
+bool Clock::stepSimulation() {
+    if (this->accumulator < globals::SIMULATION_TIME_STEP || 
+        this->frame_simulation_steps >= globals::MAX_SIMULATION_STEPS_PER_FRAME
+    ) {
+        return false;
+    }
+
+    this->accumulator -= globals::SIMULATION_TIME_STEP;
+    this->simulation_time += globals::SIMULATION_TIME_STEP;
+    this->frame_simulation_steps++;
+    return true;
+}
+
+float Clock::getInterpolationAlpha() {
+    return static_cast<float>(std::clamp(this->accumulator / globals::SIMULATION_TIME_STEP, 0.0, 1.0));
+}
+
+void Clock::setFixedFrameTime(double frame_time) {
+    this->fixed_frame_time = frame_time;
+}
+
+// Returns the simulation time step in milliseconds
 double Clock::getDeltaTime() {
+    return globals::SIMULATION_TIME_STEP;
+}
+
+// Returns the time change since the last tick in milliseconds
+double Clock::getFrameDeltaTime() {
     return delta_time;
 }
 
@@ -32,6 +70,10 @@ double Clock::getCumulativeTime() {
     return cumulative_time;
 }
 
+double Clock::getSimulationTime() {
+    return this->simulation_time;
+}
+
 double Clock::getFPS() {
     return this->fps;
 }
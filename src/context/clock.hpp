@@ -1,16 +1,35 @@
 #pragma once
 
+#include <algorithm>
+
 #include <SDL.h>
 
+#include "globals.hpp"
+
+// Tracks both the real frame time and the fixed step simulation time
+// Every frame adds its real duration to an accumulator which is then consumed in fixed steps
+//  of globals::SIMULATION_TIME_STEP by stepSimulation, so the simulation always advances by the same amount
 class Clock {
 public:
     Clock();
+    // Returns the simulation time step in milliseconds, the same for every simulation step
     double getDeltaTime();
+    // Returns the real time change since the last frame in milliseconds
+    double getFrameDeltaTime();
     double getCumulativeTime();
+    double getSimulationTime();
     double tick();
     double getFPS();
     double getSmoothedFPS();
 
+    // Returns true while there is enough accumulated time for another simulation step this frame
+    bool stepSimulation();
+    // How far the current frame is between the last and the next simulation step, from 0 to 1
+    float getInterpolationAlpha();
+    // Makes every tick take the given time in milliseconds instead of the real time
+    // Used for reproducible runs, a frame time of 0 returns to using the real time
+    void setFixedFrameTime(double frame_time);
+
 private:
     Uint64 current_frame;
     Uint64 last_frame;
@@ -19,4 +38,9 @@ private:
     double cumulative_time;
     double fps{0};
     double smoothed_fps{0};
+
+    double accumulator{0};
+    double simulation_time{0};
+    int frame_simulation_steps{0};
+    double fixed_frame_time{0};
 };
\ No newline at end of file
@@ -5,10 +5,20 @@
 #include <entt/entt.hpp>
 #include <lightgrid/grid.hpp>
 
+#include "sparse_grid.hpp"
 #include "spacial.hpp"
+#include "batched_update.hpp"
 #include "component_grid_ignore.hpp"
 #include "debug_timer.hpp"
 
+// Counts of how the grid was updated, each skipped reinsertion saves one remove and one insert
+struct ComponentGridStats {
+    size_t updates{0};
+    size_t reinsertions{0};
+    size_t skipped_reinsertions{0};
+    size_t chunks{0};
+};
+
 template<typename>
 struct GridData {
     lightgrid::bounds bounds;
@@ -26,10 +36,10 @@ public:
         entt::registry& registry, 
         std::function<lightgrid::bounds (entt::registry&, entt::entity)> getBounds
     );
-    ComponentGrid(ComponentGrid&& component_grid) = default;
-    ComponentGrid& operator=(ComponentGrid&& component_grid) = default;
 
-    void init(int width, int height, int cell_size);
+    void init(int cell_size);
+    // Sizes the grid for a map with the bounds, entities outside of them are still tracked
+    void reserve(const lightgrid::bounds& bounds);
     void update();
     void connect();
     void disconnect();
@@ -42,19 +52,37 @@ public:
     requires lightgrid::insertable<R<Rtype>, Rtype>
     R<Rtype>& query(const float x, const float y, const float w, const float h, R<entt::entity>& results);
 
+    // Safe to call from several threads while the grid is not being updated, the results can contain duplicates
+    template<template<typename Rtype> typename R, typename Rtype=entt::entity> 
+    requires lightgrid::insertable<R<Rtype>, Rtype>
+    R<Rtype>& queryShared(const lightgrid::bounds& bounds, R<entt::entity>& results) const;
+
     void clear();
 
+    // Frame stats count the updates since the last resetFrameStats
+    const ComponentGridStats& getFrameStats();
+    const ComponentGridStats& getTotalStats();
+    void resetFrameStats();
+
 private:
     void observeConstruct(entt::registry& registry, entt::entity entity);
     void observeDestroy(entt::registry& registry, entt::entity entity);
 
     std::function<lightgrid::bounds (entt::registry&, entt::entity)> getBounds;
 
-    lightgrid::grid<entt::entity> grid;
-    entt::observer observer;
+    void updateEntity(entt::entity entity);
+    bool isInSameCells(const lightgrid::bounds& bounds, const lightgrid::bounds& other_bounds);
+
+    SparseGrid<entt::entity> grid;
     entt::registry& registry;
+    entt::observer observer;
+    // Entities without GridData<Component> are not in the grid, which includes the ignored ones
+    BatchedObserver<Spacial, Component, GridData<Component>> batched_observer{BatchedObserver<Spacial, Component, GridData<Component>>(this->registry)};
 
     bool is_initialized{false};
+
+    ComponentGridStats frame_stats;
+    ComponentGridStats total_stats;
 };
 
 template<typename Component>
@@ -66,8 +94,8 @@ ComponentGrid<Component>::ComponentGrid(
 }
 
 template<typename Component>
-void ComponentGrid<Component>::init(int width, int height, int cell_size) {
-    this->grid.init(width, height, cell_size);
+void ComponentGrid<Component>::init(int cell_size) {
+    this->grid.init(cell_size);
 
     for (auto entity : this->registry.view<Component, Spacial>()) {
         this->observeConstruct(this->registry, entity);
@@ -76,29 +104,61 @@ void ComponentGrid<Component>::init(int width, int height, int cell_size) {
     this->is_initialized = true;
 }
 
+template<typename Component>
+void ComponentGrid<Component>::reserve(const lightgrid::bounds& bounds) {
+    this->grid.reserve(bounds);
+}
+
 template<typename Component>
 void ComponentGrid<Component>::update() {
     DEBUG_TIMER(_,"ComponentGrid::update");
     // Update the grid for the related component
-    this->observer.each([&, this](auto entity){
+    this->observer.each([this](auto entity) {
+        this->updateEntity(entity);
+    });
+    this->batched_observer.each([this](auto entity) {
+        this->updateEntity(entity);
+    });
+}
 
-        assert((this->registry.all_of<Spacial, GridData<Component>>(entity) && "Entity missing Spacial or GridData<T> component"));
+template<typename Component>
+void ComponentGrid<Component>::updateEntity(entt::entity entity) {
+    assert((this->registry.all_of<Spacial, GridData<Component>>(entity) && "Entity missing Spacial or GridData<T> component"));
 
-        // Remove the old data from the component grid
-        auto& grid_data = this->registry.get<GridData<Component>>(entity);
-        this->grid.remove(grid_data.node, grid_data.bounds);
+    auto& grid_data = this->registry.get<GridData<Component>>(entity);
+    const lightgrid::bounds new_bounds = this->getBounds(this->registry, entity);
 
-        // Add the new data
-        auto& spacial = this->registry.get<Spacial>(entity);
-        grid_data.bounds = this->getBounds(this->registry, entity);
-        grid_data.node = this->grid.insert(entity, grid_data.bounds);
-    });
-    
+    this->frame_stats.updates++;
+    this->total_stats.updates++;
+
+    // Most moves stay within the same cells, the grid only needs to change when the covered cells do
+    if (this->isInSameCells(grid_data.bounds, new_bounds)) {
+        grid_data.bounds = new_bounds;
+        this->frame_stats.skipped_reinsertions++;
+        this->total_stats.skipped_reinsertions++;
+        return;
+    }
+
+    // Remove the old data from the component grid
+    this->grid.remove(grid_data.node, grid_data.bounds);
+
+    // Add the new data
+    grid_data.bounds = new_bounds;
+    grid_data.node = this->grid.insert(entity, grid_data.bounds);
+
+    this->frame_stats.reinsertions++;
+    this->total_stats.reinsertions++;
+}
+
+template<typename Component>
+bool ComponentGrid<Component>::isInSameCells(const lightgrid::bounds& bounds, const lightgrid::bounds& other_bounds) {
+    return this->grid.getCellRange(bounds) == this->grid.getCellRange(other_bounds);
 }
 
 template<typename Component>
 void ComponentGrid<Component>::connect() {
     this->observer.connect(registry, entt::collector.update<Spacial>().where<Component>(entt::exclude<ComponentGridIgnore>));
+    this->batched_observer.connect();
     registry.on_construct<Component>().template connect<&ComponentGrid<Component>::observeConstruct>(this);
     registry.on_destroy<Component>().template connect<&ComponentGrid<Component>::observeDestroy>(this);
 }
@@ -106,6 +166,7 @@ void ComponentGrid<Component>::connect() {
 template<typename Component>
 void ComponentGrid<Component>::disconnect() {
     this->observer.disconnect();
+    this->batched_observer.disconnect();
     registry.on_construct<Component>().template disconnect<&ComponentGrid<Component>::observeConstruct>(this);
     registry.on_destroy<Component>().template disconnect<&ComponentGrid<Component>::observeDestroy>(this);
 }
@@ -129,11 +190,35 @@ R<Rtype>& ComponentGrid<Component>::query(float x, float y, float w, float h, R<
     }, results);
 }
 
+template<typename Component>
+template<template<typename Rtype> typename R, typename Rtype> 
+requires lightgrid::insertable<R<Rtype>, Rtype>
+R<Rtype>& ComponentGrid<Component>::queryShared(const lightgrid::bounds& bounds, R<entt::entity>& results) const {
+    return this->grid.queryShared(bounds, results);
+}
+
 template<typename Component>
 void ComponentGrid<Component>::clear() {
     this->grid.clear();
 }
 
+template<typename Component>
+const ComponentGridStats& ComponentGrid<Component>::getFrameStats() {
+    this->frame_stats.chunks = this->grid.getNumChunks();
+    return this->frame_stats;
+}
+
+template<typename Component>
+const ComponentGridStats& ComponentGrid<Component>::getTotalStats() {
+    this->total_stats.chunks = this->grid.getNumChunks();
+    return this->total_stats;
+}
+
+template<typename Component>
+void ComponentGrid<Component>::resetFrameStats() {
+    this->frame_stats = ComponentGridStats();
+}
+
 template<typename Component>
 void ComponentGrid<Component>::observeConstruct(entt::registry& registry, entt::entity entity) {
     if (registry.any_of<ComponentGridIgnore>(entity) || !this->is_initialized) {
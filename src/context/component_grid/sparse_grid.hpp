@@ -0,0 +1,272 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+#include <lightgrid/grid.hpp>
+
+// Unbounded spatial grid which only allocates the areas that have something in them
+// Cells are grouped into chunks of CHUNK_SIZE by CHUNK_SIZE cells. A chunk is allocated when the first
+//  element is inserted into it and freed when its last element is removed, so memory scales with the
+//  occupied area rather than with the size of the map
+// Elements are inserted into every cell their bounds overlap, the far edges of the bounds are exclusive
+template<typename T>
+class SparseGrid {
+public:
+    static constexpr int CHUNK_SIZE{16};
+
+    struct CellRange {
+        int min_x;
+        int min_y;
+        int max_x;
+        int max_y;
+
+        bool operator==(const CellRange&) const = default;
+    };
+
+    void init(int cell_size);
+    // Prepares for elements within the bounds, the grid still accepts elements outside of them
+    void reserve(const lightgrid::bounds& bounds);
+
+    int insert(T value, const lightgrid::bounds& bounds);
+    void remove(int node, const lightgrid::bounds& bounds);
+
+    // Inserts every element overlapping a cell within the bounds into the results, each only once
+    template<typename R>
+    R& query(const lightgrid::bounds& bounds, R& results);
+    // Does not modify the grid so it can be called from several threads at once, but an element
+    //  overlapping several of the cells is inserted once for each of them
+    template<typename R>
+    R& queryShared(const lightgrid::bounds& bounds, R& results) const;
+
+    void clear();
+
+    CellRange getCellRange(const lightgrid::bounds& bounds) const;
+    size_t getNumChunks() const;
+    size_t getNumElements() const;
+
+private:
+    struct Element {
+        T value;
+        // The last query which returned this element, used to return it only once per query
+        uint32_t query_stamp{0};
+    };
+
+    struct Chunk {
+        std::array<std::vector<int>, CHUNK_SIZE*CHUNK_SIZE> cells;
+        size_t num_entries{0};
+    };
+
+    int cellIndex(int position) const;
+    static int chunkIndex(int cell);
+    static uint64_t chunkKey(int chunk_x, int chunk_y);
+
+    // Self is const for the lookups which must not modify the grid, those never create chunks
+    template<typename Self, typename Func>
+    static void eachCell(Self& self, const CellRange& range, bool create_chunks, Func func);
+
+    int cell_size{16};
+
+    std::unordered_map<uint64_t, std::unique_ptr<Chunk>> chunks;
+    std::vector<Element> elements;
+    std::vector<int> free_elements;
+    size_t num_elements{0};
+    uint32_t current_query_stamp{0};
+};
+
+template<typename T>
+void SparseGrid<T>::init(int cell_size) {
+    this->cell_size = std::max(cell_size, 1);
+    this->clear();
+}
+
+template<typename T>
+void SparseGrid<T>::reserve(const lightgrid::bounds& bounds) {
+    if (this->num_elements == 0) {
+        // Start from a fresh map so that the buckets of a previous, larger area are released
+        this->clear();
+    }
+
+    const auto range = this->getCellRange(bounds);
+    const size_t chunks_x = chunkIndex(range.max_x) - chunkIndex(range.min_x) + 1;
+    const size_t chunks_y = chunkIndex(range.max_y) - chunkIndex(range.min_y) + 1;
+    this->chunks.reserve(chunks_x*chunks_y);
+}
+
+template<typename T>
+int SparseGrid<T>::insert(T value, const lightgrid::bounds& bounds) {
+    int node;
+    if (!this->free_elements.empty()) {
+        node = this->free_elements.back();
+        this->free_elements.pop_back();
+        this->elements[node] = Element{value};
+    } else {
+        node = static_cast<int>(this->elements.size());
+        this->elements.push_back(Element{value});
+    }
+    this->num_elements++;
+
+    eachCell(*this, this->getCellRange(bounds), true, [node](Chunk& chunk, std::vector<int>& cell) {
+        cell.push_back(node);
+        chunk.num_entries++;
+    });
+
+    return node;
+}
+
+template<typename T>
+void SparseGrid<T>::remove(int node, const lightgrid::bounds& bounds) {
+    eachCell(*this, this->getCellRange(bounds), false, [node](Chunk& chunk, std::vector<int>& cell) {
+        auto it = std::find(cell.begin(), cell.end(), node);
+        if (it != cell.end()) {
+            *it = cell.back();
+            cell.pop_back();
+            chunk.num_entries--;
+        }
+    });
+
+    // Free the chunks which are now empty
+    const auto range = this->getCellRange(bounds);
+    for (int chunk_y{chunkIndex(range.min_y)}; chunk_y <= chunkIndex(range.max_y); chunk_y++) {
+        for (int chunk_x{chunkIndex(range.min_x)}; chunk_x <= chunkIndex(range.max_x); chunk_x++) {
+            auto chunk_it = this->chunks.find(chunkKey(chunk_x, chunk_y));
+            if (chunk_it != this->chunks.end() && chunk_it->second->num_entries == 0) {
+                this->chunks.erase(chunk_it);
+            }
+        }
+    }
+
+    this->free_elements.push_back(node);
+    this->num_elements--;
+
+    if (this->num_elements == 0) {
+        this->elements.clear();
+        this->free_elements.clear();
+    }
+}
+
+template<typename T>
+template<typename R>
+R& SparseGrid<T>::query(const lightgrid::bounds& bounds, R& results) {
+    this->current_query_stamp++;
+    if (this->current_query_stamp == 0) {
+        // The stamp wrapped around, so old stamps could match again
+        for (auto& element : this->elements) {
+            element.query_stamp = 0;
+        }
+        this->current_query_stamp = 1;
+    }
+
+    eachCell(*this, this->getCellRange(bounds), false, [this, &results](Chunk&, std::vector<int>& cell) {
+        for (auto node : cell) {
+            auto& element = this->elements[node];
+            if (element.query_stamp != this->current_query_stamp) {
+                element.query_stamp = this->current_query_stamp;
+                results.insert(results.end(), element.value);
+            }
+        }
+    });
+
+    return results;
+}
+
+template<typename T>
+template<typename R>
+R& SparseGrid<T>::queryShared(const lightgrid::bounds& bounds, R& results) const {
+    eachCell(*this, this->getCellRange(bounds), false, [this, &results](const Chunk&, const std::vector<int>& cell) {
+        for (auto node : cell) {
+            results.insert(results.end(), this->elements[node].value);
+        }
+    });
+
+    return results;
+}
+
+template<typename T>
+void SparseGrid<T>::clear() {
+    this->chunks = std::unordered_map<uint64_t, std::unique_ptr<Chunk>>();
+    this->elements.clear();
+    this->free_elements.clear();
+    this->num_elements = 0;
+}
+
+template<typename T>
+typename SparseGrid<T>::CellRange SparseGrid<T>::getCellRange(const lightgrid::bounds& bounds) const {
+    const auto [x, y, w, h] = bounds;
+    return {
+        this->cellIndex(x),
+        this->cellIndex(y),
+        this->cellIndex(x + std::max(static_cast<int>(w), 1) - 1),
+        this->cellIndex(y + std::max(static_cast<int>(h), 1) - 1)
+    };
+}
+
+template<typename T>
+size_t SparseGrid<T>::getNumChunks() const {
+    return this->chunks.size();
+}
+
+template<typename T>
+size_t SparseGrid<T>::getNumElements() const {
+    return this->num_elements;
+}
+
+template<typename T>
+int SparseGrid<T>::cellIndex(int position) const {
+    // Round towards negative infinity so that negative positions do not share cell 0
+    return (position >= 0) ? position / this->cell_size : (position - this->cell_size + 1) / this->cell_size;
+}
+
+template<typename T>
+int SparseGrid<T>::chunkIndex(int cell) {
+    return (cell >= 0) ? cell / CHUNK_SIZE : (cell - CHUNK_SIZE + 1) / CHUNK_SIZE;
+}
+
+template<typename T>
+uint64_t SparseGrid<T>::chunkKey(int chunk_x, int chunk_y) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(chunk_x)) << 32) | static_cast<uint32_t>(chunk_y);
+}
+
+template<typename T>
+template<typename Self, typename Func>
+void SparseGrid<T>::eachCell(Self& self, const CellRange& range, bool create_chunks, Func func) {
+    using ChunkType = std::conditional_t<std::is_const_v<Self>, const Chunk, Chunk>;
+
+    for (int chunk_y{chunkIndex(range.min_y)}; chunk_y <= chunkIndex(range.max_y); chunk_y++) {
+        for (int chunk_x{chunkIndex(range.min_x)}; chunk_x <= chunkIndex(range.max_x); chunk_x++) {
+            ChunkType* chunk{nullptr};
+            auto chunk_it = self.chunks.find(chunkKey(chunk_x, chunk_y));
+
+            if (chunk_it != self.chunks.end()) {
+                chunk = chunk_it->second.get();
+            } else if constexpr (!std::is_const_v<Self>) {
+                if (create_chunks) {
+                    chunk = self.chunks.emplace(chunkKey(chunk_x, chunk_y), std::make_unique<Chunk>()).first->second.get();
+                }
+            }
+
+            if (chunk == nullptr) {
+                continue;
+            }
+
+            // Only the cells of the range which fall within this chunk
+            const int chunk_min_x{chunk_x*CHUNK_SIZE};
+            const int chunk_min_y{chunk_y*CHUNK_SIZE};
+            const int min_x{std::max(range.min_x, chunk_min_x) - chunk_min_x};
+            const int max_x{std::min(range.max_x, chunk_min_x + CHUNK_SIZE - 1) - chunk_min_x};
+            const int min_y{std::max(range.min_y, chunk_min_y) - chunk_min_y};
+            const int max_y{std::min(range.max_y, chunk_min_y + CHUNK_SIZE - 1) - chunk_min_y};
+
+            for (int cell_y{min_y}; cell_y <= max_y; cell_y++) {
+                for (int cell_x{min_x}; cell_x <= max_x; cell_x++) {
+                    func(*chunk, chunk->cells[cell_y*CHUNK_SIZE + cell_x]);
+                }
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -35,6 +35,16 @@ void MapLoader::loadTiledMap(const char* map_path) {
             }
         }
 
+        // Size the grids for the new map now that the old one is out of them
+        const lightgrid::bounds grid_bounds{
+            static_cast<int>(map_bounds.left),
+            static_cast<int>(map_bounds.top),
+            static_cast<int>(map_bounds.width),
+            static_cast<int>(map_bounds.height)
+        };
+        this->registry.ctx().at<ComponentGrid<Renderable>&>().reserve(grid_bounds);
+        this->registry.ctx().at<ComponentGrid<Collision>&>().reserve(grid_bounds);
+
         this->addObjects(map);
         this->addTilesets(map);
 
@@ -46,6 +56,19 @@ void MapLoader::loadTiledMap(const char* map_path) {
     }
 }
 
+std::string MapLoader::getTileSetResourceId(const tmx::Tileset& tile_set) {
+    auto resource_folder_nonrelative = globals::RESOURCE_FOLDER.substr(2);
+
+    std::string specific_resource_path{tile_set.getImagePath()};
+    size_t resource_id_start = specific_resource_path.find(resource_folder_nonrelative) + 
+        resource_folder_nonrelative.length();
+
+    return specific_resource_path.substr(
+        resource_id_start,
+        specific_resource_path.find_last_of('/') - resource_id_start
+    );
+}
+
 void MapLoader::addObjects(const tmx::Map& map) {
     const auto& layers = map.getLayers();
 
@@ -150,46 +173,52 @@ void MapLoader::addTilesets(tmx::Map& map) {
         const auto& tile_set_entity = this->registry.create();
 
         std::string sprite_sheet_name = std::filesystem::path(tile_set.getImagePath()).stem().string(); 
-        auto resource_folder_nonrelative = globals::RESOURCE_FOLDER.substr(2);
-
-        std::string specific_resource_path{tile_set.getImagePath()};
-        size_t resource_id_start = specific_resource_path.find(resource_folder_nonrelative) + 
-            resource_folder_nonrelative.length();
-
-        std::string resource_id = specific_resource_path.substr(
-            resource_id_start,
-            specific_resource_path.find_last_of('/') - resource_id_start
-        );
+        std::string resource_id = getTileSetResourceId(tile_set);
         
         this->registry.emplace<TileSet>(tile_set_entity, (int)dimensions.x, (int)dimensions.y, (int)tile_set.getFirstGID(), (int)tile_set.getLastGID());
         // Animations and textures for tiles are handled by the tile_set. 
         //      Animations for all tiles in the tile_set can then be done at once
-        //      The drawback for this is that the textures coordinates are calculated every frame
-        //      Another drawback is that adding the buffer data for tiles and other entities ends 
-        //      up being different.
-        auto& sprite_sheet = sprite_sheet_atlas.initSpriteSheet(registry, resource_id);
+        //      The tile chunks are drawn with the tile_set's current frame as an offset into the atlas
+        auto& sprite_sheet = sprite_sheet_atlas.initSpriteSheet(registry, resource_id, TextureCategory::TILE);
         auto& [default_animation_name, default_animation] = *(sprite_sheet.animations.begin());
         auto& tile_set_texure = this->registry.emplace<Texture>(tile_set_entity, sprite_sheet_name, default_animation.frames[0]);
         auto& animator = this->registry.emplace<Animator>(tile_set_entity, &default_animation.frame_durations);
         this->registry.emplace<Animation>(tile_set_entity, &animator, &default_animation);
         
+        // Tiles are baked into chunks which are drawn whole, only tiles with collision boxes get their own entity
+        const int chunks_per_row = (dimensions.x + TileChunk::SIZE - 1)/TileChunk::SIZE;
+        std::unordered_map<int, entt::entity> chunk_entities;
+
         for (auto tile_data_vec : tile_data_map[tile_set.getName()]) {
             const tmx::Tileset::Tile* tile = tile_set.getTile(tile_data_vec.z);
 
-            const auto& tile_entity = this->registry.create();
-
             // The position of the tile texture in the tile_set image.
             glm::vec2 image_position = glm::vec2((float)tile->imagePosition.x, (float)tile->imagePosition.y);
+            glm::vec2 position = glm::vec2(tile_data_vec.x, tile_data_vec.y) * 16.0f;
+
+            const int chunk_x = (int)tile_data_vec.x/TileChunk::SIZE;
+            const int chunk_y = (int)tile_data_vec.y/TileChunk::SIZE;
+            auto [chunk_it, is_new_chunk] = chunk_entities.try_emplace(chunk_y*chunks_per_row + chunk_x);
+            if (is_new_chunk) {
+                chunk_it->second = this->registry.create();
+                this->registry.emplace<Spacial>(
+                    chunk_it->second, 
+                    glm::vec3(chunk_x, chunk_y, 0) * (float)(TileChunk::SIZE*16), 
+                    glm::vec2(TileChunk::SIZE*16, TileChunk::SIZE*16)
+                );
+                this->registry.emplace<TileChunk>(chunk_it->second, &tile_set_texure);
+                this->registry.emplace<Renderable>(chunk_it->second);
+            }
 
-            this->registry.emplace<Spacial>(
-                tile_entity, 
-                glm::vec3(tile_data_vec.x, tile_data_vec.y, 0) * 16.0f, 
-                glm::vec2(16, 16)
-            );
-            this->registry.emplace<Tile>(tile_entity, (int)tile_data_vec.z, image_position, &tile_set_texure);
-            this->registry.emplace<Renderable>(tile_entity);
+            auto& tile_chunk = this->registry.get<TileChunk>(chunk_it->second);
+            tile_chunk.positions.push_back(position);
+            tile_chunk.texture_data.emplace_back(image_position.x, image_position.y, 16, 16);
 
-            this->addCollision(tile_entity, tile);
+            if (!tile->objectGroup.getObjects().empty()) {
+                const auto& tile_entity = this->registry.create();
+                this->registry.emplace<Spacial>(tile_entity, glm::vec3(position, 0), glm::vec2(16, 16));
+                this->addCollision(tile_entity, tile);
+            }
         }
     }
 }
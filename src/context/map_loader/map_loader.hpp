@@ -21,7 +21,7 @@
 #include "collision.hpp"
 #include "collidable.hpp"
 #include "tile_set.hpp"
-#include "tile.hpp"
+#include "tile_chunk.hpp"
 #include "renderable.hpp"
 #include "text.hpp"
 #include "name.hpp"
@@ -43,6 +43,9 @@ public:
     void queueLoad(const char* map_path);
     void loadIfQueued();
 
+    // The tile set's image is loaded as the sprite sheet with this id
+    static std::string getTileSetResourceId(const tmx::Tileset& tile_set);
+
     template<auto Func>
     void connectBeforeDestroy() {
         entt::sink sink{this->before_destroy};
@@ -0,0 +1,42 @@
+#include "asset_load_stats.hpp"
+
+std::atomic<size_t> AssetLoadStats::num_allocations{0};
+std::vector<AssetLoadRecord> AssetLoadStats::records;
+
+void* AssetLoadStats::countedMalloc(size_t size) {
+    AssetLoadStats::num_allocations++;
+    return std::malloc(size);
+}
+
+void* AssetLoadStats::countedRealloc(void* pointer, size_t size) {
+    AssetLoadStats::num_allocations++;
+    return std::realloc(pointer, size);
+}
+
+void AssetLoadStats::record(const AssetLoadRecord& record) {
+    AssetLoadStats::records.push_back(record);
+}
+
+const std::vector<AssetLoadRecord>& AssetLoadStats::getRecords() {
+    return AssetLoadStats::records;
+}
+
+size_t AssetLoadStats::getNumAllocations() {
+    return AssetLoadStats::num_allocations;
+}
+
+AssetLoadTimer::AssetLoadTimer(const std::string& path, size_t bytes) : 
+    path{path}, 
+    bytes{bytes}, 
+    start_allocations{AssetLoadStats::getNumAllocations()}, 
+    start{std::chrono::steady_clock::now()} {}
+
+AssetLoadTimer::~AssetLoadTimer() {
+    const auto end = std::chrono::steady_clock::now();
+    AssetLoadStats::record({
+        this->path,
+        this->bytes,
+        AssetLoadStats::getNumAllocations() - this->start_allocations,
+        std::chrono::duration<double, std::milli>(end - this->start).count()
+    });
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+
+// How long one asset file took to load and how many heap allocations decoding it made
+struct AssetLoadRecord {
+    std::string path;
+    size_t bytes{0};
+    size_t allocations{0};
+    double load_time{0.0}; // Milliseconds
+};
+
+// Keeps a record for every asset loaded through the mapped files
+// Only the decoders which allocate through countedMalloc and countedRealloc are counted, stb_image and the JSON pool
+class AssetLoadStats {
+public:
+    static void* countedMalloc(size_t size);
+    static void* countedRealloc(void* pointer, size_t size);
+
+    static void record(const AssetLoadRecord& record);
+    static const std::vector<AssetLoadRecord>& getRecords();
+    static size_t getNumAllocations();
+
+private:
+    static std::atomic<size_t> num_allocations;
+    static std::vector<AssetLoadRecord> records;
+};
+
+// Records the time and allocations from its construction until it is destroyed against one asset
+class AssetLoadTimer {
+public:
+    AssetLoadTimer(const std::string& path, size_t bytes);
+    ~AssetLoadTimer();
+
+private:
+    std::string path;
+    size_t bytes;
+    size_t start_allocations;
+    std::chrono::steady_clock::time_point start;
+};
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path) {
+    this->open(path);
+}
+
+MappedFile::~MappedFile() {
+    this->close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    this->close();
+
+    #ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size)) {
+            CloseHandle(file);
+            return false;
+        }
+        this->file_handle = file;
+        this->mapped_size = static_cast<size_t>(file_size.QuadPart);
+        this->is_open = true;
+        // Empty files can not be mapped, they are open with no data
+        if (this->mapped_size == 0) {
+            return true;
+        }
+
+        this->mapping_handle = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (this->mapping_handle == NULL) {
+            this->close();
+            return false;
+        }
+        this->mapped_data = static_cast<const unsigned char*>(MapViewOfFile(this->mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    #else
+        this->file_descriptor = ::open(path.c_str(), O_RDONLY);
+        if (this->file_descriptor < 0) {
+            return false;
+        }
+        struct stat file_stat;
+        if (fstat(this->file_descriptor, &file_stat) != 0) {
+            this->close();
+            return false;
+        }
+        this->mapped_size = static_cast<size_t>(file_stat.st_size);
+        this->is_open = true;
+        // Empty files can not be mapped, they are open with no data
+        if (this->mapped_size == 0) {
+            return true;
+        }
+
+        void* mapping = mmap(NULL, this->mapped_size, PROT_READ, MAP_PRIVATE, this->file_descriptor, 0);
+        if (mapping != MAP_FAILED) {
+            this->mapped_data = static_cast<const unsigned char*>(mapping);
+        }
+    #endif
+
+    if (this->mapped_data == nullptr) {
+        #ifndef NDEBUG
+            std::cerr << "ERROR: Unable to map " << path << "\n";
+        #endif
+        this->close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    #ifdef _WIN32
+        if (this->mapped_data != nullptr) {
+            UnmapViewOfFile(this->mapped_data);
+        }
+        if (this->mapping_handle != nullptr) {
+            CloseHandle(this->mapping_handle);
+        }
+        if (this->file_handle != nullptr) {
+            CloseHandle(this->file_handle);
+        }
+        this->mapping_handle = nullptr;
+        this->file_handle = nullptr;
+    #else
+        if (this->mapped_data != nullptr) {
+            munmap(const_cast<unsigned char*>(this->mapped_data), this->mapped_size);
+        }
+        if (this->file_descriptor >= 0) {
+            ::close(this->file_descriptor);
+        }
+        this->file_descriptor = -1;
+    #endif
+
+    this->mapped_data = nullptr;
+    this->mapped_size = 0;
+    this->is_open = false;
+}
+
+bool MappedFile::isOpen() const {
+    return this->is_open;
+}
+
+const unsigned char* MappedFile::data() const {
+    return this->mapped_data;
+}
+
+size_t MappedFile::size() const {
+    return this->mapped_size;
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <iostream>
+#include <cstddef>
+
+// A read only view of a whole file, mapped into memory so it can be read without copying it
+// The mapping is released when the MappedFile is destroyed, so pointers into it must not outlive it
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Closes any file already open, returns false if the file could not be mapped
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const;
+    const unsigned char* data() const;
+    size_t size() const;
+
+private:
+    const unsigned char* mapped_data{nullptr};
+    size_t mapped_size{0};
+    bool is_open{false};
+
+    #ifdef _WIN32
+        void* file_handle{nullptr};
+        void* mapping_handle{nullptr};
+    #else
+        int file_descriptor{-1};
+    #endif
+};
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "headless.hpp"
+
+bool Headless::enabled = false;
+HeadlessFrameStats Headless::current_frame_stats;
+HeadlessFrameStats Headless::last_frame_stats;
+HeadlessFrameStats Headless::total_stats;
+
+void Headless::enable() {
+    Headless::enabled = true;
+}
+
+bool Headless::isEnabled() {
+    return Headless::enabled;
+}
+
+void Headless::recordDraw(size_t num_instances) {
+    Headless::current_frame_stats.draw_calls++;
+    Headless::current_frame_stats.instances += num_instances;
+}
+
+void Headless::recordProgramSwitch() {
+    Headless::current_frame_stats.program_switches++;
+}
+
+void Headless::recordBufferUpload(size_t num_bytes) {
+    Headless::current_frame_stats.buffer_uploads++;
+    Headless::current_frame_stats.buffer_bytes += num_bytes;
+}
+
+void Headless::recordTextureUpload(size_t num_bytes) {
+    Headless::current_frame_stats.texture_uploads++;
+    Headless::current_frame_stats.texture_bytes += num_bytes;
+}
+
+void Headless::endFrame() {
+    auto& current{Headless::current_frame_stats};
+    auto& total{Headless::total_stats};
+
+    total.draw_calls += current.draw_calls;
+    total.instances += current.instances;
+    total.program_switches += current.program_switches;
+    total.buffer_uploads += current.buffer_uploads;
+    total.buffer_bytes += current.buffer_bytes;
+    total.texture_uploads += current.texture_uploads;
+    total.texture_bytes += current.texture_bytes;
+
+    Headless::last_frame_stats = current;
+    current = HeadlessFrameStats();
+}
+
+const HeadlessFrameStats& Headless::getLastFrameStats() {
+    return Headless::last_frame_stats;
+}
+
+const HeadlessFrameStats& Headless::getTotalStats() {
+    return Headless::total_stats;
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+
+// Counts of the GPU work which would have been submitted while running headless
+struct HeadlessFrameStats {
+    size_t draw_calls{0};
+    size_t instances{0};
+    size_t program_switches{0};
+    size_t buffer_uploads{0};
+    size_t buffer_bytes{0};
+    size_t texture_uploads{0};
+    size_t texture_bytes{0};
+};
+
+// The headless backend stands in for OpenGL when there is no window or GPU available
+// When enabled, the Renderer, TextureAtlas and ShaderProgram skip every GL call and instead
+//  record the draw calls and uploads they would have made
+class Headless {
+public:
+    static void enable();
+    static bool isEnabled();
+
+    static void recordDraw(size_t num_instances);
+    static void recordProgramSwitch();
+    static void recordBufferUpload(size_t num_bytes);
+    static void recordTextureUpload(size_t num_bytes);
+
+    // Moves the stats recorded since the last call into the last frame and the running total
+    static void endFrame();
+
+    static const HeadlessFrameStats& getLastFrameStats();
+    static const HeadlessFrameStats& getTotalStats();
+
+private:
+    static bool enabled;
+
+    static HeadlessFrameStats current_frame_stats;
+    static HeadlessFrameStats last_frame_stats;
+    static HeadlessFrameStats total_stats;
+};
\ No newline at end of file
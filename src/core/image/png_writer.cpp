@@ -0,0 +1,94 @@
+#include "png_writer.hpp"
+
+namespace {
+
+uint32_t getCrc(const unsigned char* data, size_t size, uint32_t crc = 0) {
+    static const auto table = [](){
+        std::array<uint32_t, 256> table;
+        for (uint32_t it{0}; it < 256; it++) {
+            uint32_t value{it};
+            for (int bit{0}; bit < 8; bit++) {
+                value = (value & 1) ? (0xEDB88320u ^ (value >> 1)) : (value >> 1);
+            }
+            table[it] = value;
+        }
+        return table;
+    }();
+
+    crc = ~crc;
+    for (size_t it{0}; it < size; it++) {
+        crc = table[(crc ^ data[it]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void pushBigEndian(std::vector<unsigned char>& bytes, uint32_t value) {
+    bytes.push_back((value >> 24) & 0xFF);
+    bytes.push_back((value >> 16) & 0xFF);
+    bytes.push_back((value >> 8) & 0xFF);
+    bytes.push_back(value & 0xFF);
+}
+
+// The length, type, data and a crc of the type and data
+void pushChunk(std::vector<unsigned char>& png, const char* type, const std::vector<unsigned char>& data) {
+    pushBigEndian(png, static_cast<uint32_t>(data.size()));
+    const size_t type_start = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data.begin(), data.end());
+    pushBigEndian(png, getCrc(png.data() + type_start, png.size() - type_start));
+}
+
+}
+
+bool writePng(const std::string& path, int width, int height, const unsigned char* pixels) {
+    const size_t row_size = static_cast<size_t>(width)*4;
+
+    // Every row starts with its filter type, none
+    std::vector<unsigned char> filtered;
+    filtered.reserve((row_size + 1)*height);
+    for (int row{0}; row < height; row++) {
+        filtered.push_back(0);
+        filtered.insert(filtered.end(), pixels + row*row_size, pixels + (row + 1)*row_size);
+    }
+
+    // A zlib stream of stored deflate blocks, each holding at most 65535 bytes
+    constexpr size_t MAX_BLOCK_SIZE{65535};
+    std::vector<unsigned char> zlib{0x78, 0x01};
+    uint32_t adler_a{1};
+    uint32_t adler_b{0};
+    size_t offset{0};
+    do {
+        const size_t block_size = std::min(MAX_BLOCK_SIZE, filtered.size() - offset);
+        const bool is_last = offset + block_size == filtered.size();
+        zlib.push_back(is_last ? 1 : 0);
+        zlib.push_back(block_size & 0xFF);
+        zlib.push_back((block_size >> 8) & 0xFF);
+        zlib.push_back(~block_size & 0xFF);
+        zlib.push_back((~block_size >> 8) & 0xFF);
+        for (size_t it{offset}; it < offset + block_size; it++) {
+            adler_a = (adler_a + filtered[it]) % 65521;
+            adler_b = (adler_b + adler_a) % 65521;
+        }
+        zlib.insert(zlib.end(), filtered.begin() + offset, filtered.begin() + offset + block_size);
+        offset += block_size;
+    } while (offset < filtered.size());
+    pushBigEndian(zlib, (adler_b << 16) | adler_a);
+
+    std::vector<unsigned char> header;
+    pushBigEndian(header, static_cast<uint32_t>(width));
+    pushBigEndian(header, static_cast<uint32_t>(height));
+    // 8 bit depth, RGBA, deflate, no filtering method, not interlaced
+    header.insert(header.end(), {8, 6, 0, 0, 0});
+
+    std::vector<unsigned char> png{0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    pushChunk(png, "IHDR", header);
+    pushChunk(png, "IDAT", zlib);
+    pushChunk(png, "IEND", {});
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(png.data()), png.size());
+    return static_cast<bool>(file);
+}
\ No newline at end of file
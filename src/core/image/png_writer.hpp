@@ -0,0 +1,14 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+// Writes 8 bit RGBA pixels, top row first, as a PNG
+// The image data is stored without compression, which keeps the writer small and is only
+//  meant for test output such as render test screenshots, which are read back with stb_image
+bool writePng(const std::string& path, int width, int height, const unsigned char* pixels);
\ No newline at end of file
@@ -24,7 +24,9 @@ void Input::update() {
         // Handle events on queue
         while (SDL_PollEvent(&event) != 0) {
             #ifndef NDEBUG
-                ImGui_ImplSDL2_ProcessEvent(&event);
+                if (!Headless::isEnabled()) {
+                    ImGui_ImplSDL2_ProcessEvent(&event);
+                }
             #endif
             
             switch (event.type) {
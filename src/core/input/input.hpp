@@ -16,6 +16,7 @@
 #include "clock.hpp"
 
 #include "globals.hpp"
+#include "headless.hpp"
 
 #include "debug_timer.hpp"
 
@@ -0,0 +1,57 @@
+#include "input_script.hpp"
+
+InputScript::InputScript(const char* script_path) {
+    std::ifstream script_stream(script_path, std::ios::in);
+
+    if (!script_stream.is_open()) {
+        std::cerr << "Unable to open input script " << script_path << "\n";
+        return;
+    }
+
+    std::string line;
+    while (std::getline(script_stream, line)) {
+        std::istringstream line_stream(line);
+
+        ScriptedEvent scripted_event{};
+        std::string event_name;
+        std::string argument;
+
+        if (!(line_stream >> scripted_event.frame >> event_name)) {
+            continue;
+        }
+        line_stream >> argument;
+
+        SDL_Event& event{scripted_event.event};
+
+        if (event_name == "key_down" || event_name == "key_up") {
+            event.type = (event_name == "key_down") ? SDL_KEYDOWN : SDL_KEYUP;
+            event.key.keysym.sym = SDL_GetKeyFromName(argument.c_str());
+
+            if (event.key.keysym.sym == SDLK_UNKNOWN) {
+                std::cerr << "Unknown key in input script: " << argument << "\n";
+                continue;
+            }
+        } else if (event_name == "mouse_down" || event_name == "mouse_up") {
+            event.type = (event_name == "mouse_down") ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+            event.button.button = static_cast<Uint8>(std::atoi(argument.c_str()));
+        } else if (event_name == "quit") {
+            event.type = SDL_QUIT;
+        } else {
+            std::cerr << "Unknown event in input script: " << event_name << "\n";
+            continue;
+        }
+
+        this->events.push_back(scripted_event);
+    }
+
+    std::stable_sort(this->events.begin(), this->events.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.frame < rhs.frame;
+    });
+}
+
+void InputScript::pushEvents(size_t frame) {
+    while (this->next_event < this->events.size() && this->events[this->next_event].frame <= frame) {
+        SDL_PushEvent(&this->events[this->next_event].event);
+        this->next_event++;
+    }
+}
\ No newline at end of file
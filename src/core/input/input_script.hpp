@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+
+#include <SDL.h>
+
+// Scripted input for driving the game without a user, eg. while running headless
+// Each line of a script is "<frame> <event> [argument]" where the event is one of:
+//  key_down <key name>, key_up <key name>, mouse_down <button>, mouse_up <button>, quit
+// Key names are the names given by SDL_GetKeyName, eg. "W" or "Space"
+// Lines which do not start with a frame number, such as "# comments", are ignored
+class InputScript {
+public:
+    InputScript() = default;
+    InputScript(const char* script_path);
+
+    // Pushes the events scripted for the given frame onto the SDL event queue
+    void pushEvents(size_t frame);
+
+private:
+    struct ScriptedEvent {
+        size_t frame;
+        SDL_Event event;
+    };
+
+    std::vector<ScriptedEvent> events;
+    size_t next_event{0};
+};
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+// Maps a float to an unsigned key in the same order, negative floats have their bits flipped
+//  so that they sort below the positive ones, and the sign bit is set on the positive ones
+inline uint32_t getRadixKey(const float value) {
+    const uint32_t bits = std::bit_cast<uint32_t>(value);
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+// Stable least significant digit radix sort of values by an unsigned integer key, one byte per pass
+// Every histogram is counted in a single read of the keys, bytes which are the same for every key
+//  are skipped, so keys with unused high bits cost no more than their used bits
+// scratch is resized to match and left with unspecified contents
+template<typename T, typename GetKey>
+void radixSort(std::vector<T>& values, std::vector<T>& scratch, GetKey get_key) {
+    using Key = std::decay_t<decltype(get_key(std::declval<const T&>()))>;
+    static_assert(std::is_unsigned_v<Key>, "radix sort keys must be unsigned integers");
+    constexpr size_t NUM_PASSES{sizeof(Key)};
+    constexpr size_t RADIX{256};
+
+    const size_t size = values.size();
+    if (size < 2) {
+        return;
+    }
+
+    std::array<std::array<size_t, RADIX>, NUM_PASSES> histograms{};
+    for (const auto& value : values) {
+        Key key = get_key(value);
+        for (size_t pass{0}; pass < NUM_PASSES; pass++) {
+            histograms[pass][key & 0xFF]++;
+            key >>= 8;
+        }
+    }
+
+    scratch.resize(size);
+    std::vector<T>* source = &values;
+    std::vector<T>* destination = &scratch;
+
+    for (size_t pass{0}; pass < NUM_PASSES; pass++) {
+        auto& histogram = histograms[pass];
+
+        const Key first_digit = (get_key(source->front()) >> (pass*8)) & 0xFF;
+        if (histogram[first_digit] == size) {
+            continue;
+        }
+
+        size_t offset{0};
+        for (auto& count : histogram) {
+            const size_t bucket_size = count;
+            count = offset;
+            offset += bucket_size;
+        }
+
+        for (auto& value : *source) {
+            const Key digit = (get_key(value) >> (pass*8)) & 0xFF;
+            (*destination)[histogram[digit]++] = std::move(value);
+        }
+        std::swap(source, destination);
+    }
+
+    if (source != &values) {
+        values.swap(scratch);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
+
+// One quad as uploaded for the instanced shaders
+// Quads are axis aligned apart from a rotation around their center, anything else is drawn from a MatrixInstance
+struct Instance {
+    // Top left corner, z is the depth the quad is drawn at
+    glm::vec3 position;
+    // Radians around the center of the quad
+    float rotation;
+    glm::vec2 size;
+    // x, y, width, height in pixels
+    glm::u16vec4 texture_data;
+};
+static_assert(sizeof(Instance) == 32, "Instance is uploaded as is, its layout must match the vertex attributes");
+// The position and rotation are read as one vec4
+static_assert(offsetof(Instance, rotation) == offsetof(Instance, position) + sizeof(glm::vec3));
+
+// A quad placed by a full model matrix, for the shaders taking one
+struct MatrixInstance {
+    glm::vec4 texture_data;
+    glm::mat4 model;
+};
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "instance_ring.hpp"
+
+namespace {
+    // Keeps every upload aligned for the vertex attributes reading it
+    constexpr size_t UPLOAD_ALIGNMENT{16};
+
+    constexpr GLbitfield PERSISTENT_MAP_FLAGS{GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT};
+}
+
+InstanceRing::~InstanceRing() {
+    this->release();
+}
+
+void InstanceRing::init(size_t region_size) {
+    this->is_persistent = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+    this->allocate(region_size);
+}
+
+GLuint InstanceRing::getBuffer() const {
+    return this->vbo;
+}
+
+bool InstanceRing::isPersistent() const {
+    return this->is_persistent;
+}
+
+size_t InstanceRing::upload(const void* data, size_t num_bytes) {
+    if (this->cursor + num_bytes > this->region_size) {
+        // Draws already made this frame keep the old buffer alive until the GPU is done with it
+        size_t new_region_size = std::max(this->region_size, UPLOAD_ALIGNMENT)*2;
+        while (new_region_size < num_bytes) {
+            new_region_size *= 2;
+        }
+        this->allocate(new_region_size);
+    }
+    if (!this->is_frame_started) {
+        this->beginFrame();
+    }
+
+    const size_t offset = this->region*this->region_size + this->cursor;
+    if (this->is_persistent) {
+        std::memcpy(this->mapped_data + offset, data, num_bytes);
+    } else {
+        // The range was never written since the buffer was orphaned, so nothing can be reading it
+        glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+        void* destination = glMapBufferRange(GL_ARRAY_BUFFER, offset, num_bytes, 
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        std::memcpy(destination, data, num_bytes);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    this->cursor += (num_bytes + UPLOAD_ALIGNMENT - 1)/UPLOAD_ALIGNMENT*UPLOAD_ALIGNMENT;
+    return offset;
+}
+
+void InstanceRing::endFrame() {
+    if (!this->is_frame_started) {
+        return;
+    }
+    if (this->is_persistent) {
+        this->fences[this->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        this->region = (this->region + 1) % NUM_REGIONS;
+    }
+    this->cursor = 0;
+    this->is_frame_started = false;
+}
+
+void InstanceRing::beginFrame() {
+    this->is_frame_started = true;
+
+    if (!this->is_persistent) {
+        // Orphan the storage, the driver hands out new memory while the old is still being drawn from
+        glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+        glBufferData(GL_ARRAY_BUFFER, this->region_size, NULL, GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        return;
+    }
+
+    GLsync& fence = this->fences[this->region];
+    if (fence == nullptr) {
+        return;
+    }
+    // Only blocks when the CPU is more than NUM_REGIONS - 1 frames ahead of the GPU
+    GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    while (result == GL_TIMEOUT_EXPIRED) {
+        result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void InstanceRing::allocate(size_t region_size) {
+    this->release();
+
+    this->region_size = region_size;
+    this->region = 0;
+    this->cursor = 0;
+    this->is_frame_started = false;
+
+    glGenBuffers(1, &this->vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+    if (this->is_persistent) {
+        glBufferStorage(GL_ARRAY_BUFFER, region_size*NUM_REGIONS, NULL, PERSISTENT_MAP_FLAGS);
+        this->mapped_data = static_cast<char*>(
+            glMapBufferRange(GL_ARRAY_BUFFER, 0, region_size*NUM_REGIONS, PERSISTENT_MAP_FLAGS)
+        );
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, region_size, NULL, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstanceRing::release() {
+    if (this->vbo == 0) {
+        return;
+    }
+    if (this->mapped_data != nullptr) {
+        glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        this->mapped_data = nullptr;
+    }
+    for (auto& fence : this->fences) {
+        if (fence != nullptr) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    glDeleteBuffers(1, &this->vbo);
+    this->vbo = 0;
+}
\ No newline at end of file
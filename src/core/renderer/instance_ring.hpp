@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+#include <GL\glew.h>
+
+// Streams instance data to the GPU without waiting on draws which are still reading the buffer
+// With GL 4.4 or ARB_buffer_storage the buffer is persistently mapped and split into regions,
+//  each frame writes into the next region once the fence placed after its last use has signaled
+// Otherwise the buffer is orphaned at the start of every frame and written with unsynchronized maps
+class InstanceRing {
+public:
+    static constexpr size_t NUM_REGIONS{3};
+
+    InstanceRing() = default;
+    ~InstanceRing();
+
+    InstanceRing(const InstanceRing&) = delete;
+    InstanceRing& operator=(const InstanceRing&) = delete;
+
+    void init(size_t region_size);
+
+    // Appends the data to this frame's region and returns its byte offset in the buffer
+    // The buffer is reallocated when the region is full, so it must be re-read after every upload
+    size_t upload(const void* data, size_t num_bytes);
+    // Must be called after the last draw reading this frame's data
+    void endFrame();
+
+    GLuint getBuffer() const;
+    bool isPersistent() const;
+
+private:
+    void allocate(size_t region_size);
+    void release();
+    void beginFrame();
+
+    GLuint vbo{0};
+    bool is_persistent{false};
+    char* mapped_data{nullptr};
+
+    size_t region_size{0};
+    size_t region{0};
+    size_t cursor{0};
+    bool is_frame_started{false};
+
+    GLsync fences[NUM_REGIONS]{};
+};
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include "post_process_chain.hpp"
+
+size_t PostProcessChain::addPass(const std::string& name, ShaderProgram* shader_program, float scale, bool is_enabled) {
+    this->passes.push_back({name, shader_program, scale, is_enabled});
+    return this->passes.size() - 1;
+}
+
+void PostProcessChain::setEnabled(size_t pass, bool is_enabled) {
+    this->passes[pass].is_enabled = is_enabled;
+}
+
+bool PostProcessChain::isEnabled(size_t pass) const {
+    return this->passes[pass].is_enabled;
+}
+
+bool PostProcessChain::hasEnabledPasses() const {
+    return std::any_of(this->passes.begin(), this->passes.end(), [](const auto& pass) {
+        return pass.is_enabled;
+    });
+}
+
+const std::vector<PostProcessPass>& PostProcessChain::getPasses() const {
+    return this->passes;
+}
+
+glm::ivec2 PostProcessChain::getPassSize(size_t pass) const {
+    const glm::vec2 screen_size{globals::SCREEN_WIDTH, globals::SCREEN_HEIGHT};
+    return glm::max(glm::ivec2(screen_size*this->passes[pass].scale), glm::ivec2(1));
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+#include "globals.hpp"
+#include "shader_program.hpp"
+
+// A full screen pass reading the output of the enabled pass before it, or the rendered scene for the first
+struct PostProcessPass {
+    std::string name;
+    ShaderProgram* shader_program;
+    // Fraction of the screen resolution the pass is drawn at
+    float scale{1.0f};
+    bool is_enabled{true};
+};
+
+// The post processing passes in the order they are drawn, declared once and drawn every frame by the Renderer
+// Disabled passes are skipped without drawing or acquiring a render target
+class PostProcessChain {
+public:
+    // Returns the index of the pass, used to enable or disable it
+    size_t addPass(const std::string& name, ShaderProgram* shader_program, float scale = 1.0f, bool is_enabled = true);
+    void setEnabled(size_t pass, bool is_enabled);
+    bool isEnabled(size_t pass) const;
+    bool hasEnabledPasses() const;
+
+    const std::vector<PostProcessPass>& getPasses() const;
+    // The size of the pass's render target, at least one pixel
+    glm::ivec2 getPassSize(size_t pass) const;
+
+private:
+    std::vector<PostProcessPass> passes;
+};
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+enum class StencilState : uint8_t {
+    NONE,
+    // Draws only mark the stencil buffer
+    WRITE,
+    // Draws only cover what was marked
+    TEST
+};
+
+// Camera uniforms given to every shader drawing with the view
+struct RenderView {
+    glm::mat4 projection{1.0f};
+    glm::mat4 view{1.0f};
+    float zoom{1.0f};
+};
+
+// Where a command is drawn in the frame, layers are drawn in order and each layer by depth
+// Commands with the same layer and depth are grouped by their state, otherwise keeping the order they were queued in
+struct RenderKey {
+    uint8_t layer{0};
+    uint32_t depth{0};
+    uint8_t view{0};
+    StencilState stencil{StencilState::NONE};
+};
+
+enum class RenderCommandType : uint8_t {
+    INSTANCE,
+    MATRIX_INSTANCE,
+    STATIC_INSTANCES
+};
+
+// Commands are sorted once per frame by their key, which is packed from the most significant bit as
+//  layer (8) | depth (32) | stencil (2) | view (4) | shader (8) | type (2) | unused (8)
+// The bits under the depth are the state a draw needs, consecutive commands with the same state share a draw
+struct RenderCommand {
+    uint64_t key;
+    // Index of the queued instance, matrix instance or static instances the type refers to
+    uint32_t index;
+
+    static constexpr uint64_t STATE_MASK{(uint64_t{1} << 24) - 1};
+    static constexpr size_t MAX_VIEWS{16};
+    static constexpr size_t MAX_SHADERS{256};
+
+    static uint64_t makeKey(const RenderKey& render_key, uint8_t shader_id, RenderCommandType type) {
+        return uint64_t{render_key.layer} << 56 | 
+            uint64_t{render_key.depth} << 24 | 
+            uint64_t(render_key.stencil) << 22 | 
+            uint64_t(render_key.view & 0xF) << 18 | 
+            uint64_t{shader_id} << 10 | 
+            uint64_t(type) << 8;
+    }
+
+    static uint64_t getState(uint64_t key) {
+        return key & STATE_MASK;
+    }
+    static StencilState getStencil(uint64_t key) {
+        return StencilState((key >> 22) & 0x3);
+    }
+    static uint8_t getView(uint64_t key) {
+        return (key >> 18) & 0xF;
+    }
+    static uint8_t getShaderId(uint64_t key) {
+        return (key >> 10) & 0xFF;
+    }
+    static RenderCommandType getType(uint64_t key) {
+        return RenderCommandType((key >> 8) & 0x3);
+    }
+};
\ No newline at end of file
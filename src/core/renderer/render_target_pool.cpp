@@ -0,0 +1,56 @@
+#include "render_target_pool.hpp"
+
+RenderTargetPool::~RenderTargetPool() {
+    if (Headless::isEnabled()) {
+        return;
+    }
+    for (const auto& render_target : this->targets) {
+        glDeleteFramebuffers(1, &render_target.fbo);
+        glDeleteTextures(1, &render_target.texture);
+    }
+}
+
+RenderTarget RenderTargetPool::acquire(glm::ivec2 size) {
+    for (auto it = this->free_targets.begin(); it != this->free_targets.end(); it++) {
+        if (it->size == size) {
+            const RenderTarget render_target = *it;
+            this->free_targets.erase(it);
+            return render_target;
+        }
+    }
+    return this->create(size);
+}
+
+void RenderTargetPool::release(const RenderTarget& render_target) {
+    this->free_targets.push_back(render_target);
+}
+
+size_t RenderTargetPool::getNumTargets() const {
+    return this->targets.size();
+}
+
+RenderTarget RenderTargetPool::create(glm::ivec2 size) {
+    RenderTarget render_target{0, 0, size};
+    if (!Headless::isEnabled()) {
+        glGenFramebuffers(1, &render_target.fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, render_target.fbo);
+        glDrawBuffer(GL_COLOR_ATTACHMENT0);
+
+        glGenTextures(1, &render_target.texture);
+        glBindTexture(GL_TEXTURE_2D, render_target.texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, size.x, size.y, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+        // Linear so that passes at a lower resolution are smoothly scaled back up
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, render_target.texture, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "ERROR: Framebuffer is not complete!" << std::endl;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+    this->targets.push_back(render_target);
+    return render_target;
+}
\ No newline at end of file
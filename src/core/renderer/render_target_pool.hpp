@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include <iostream>
+
+#include <GL\glew.h>
+#include <glm/glm.hpp>
+
+#include "headless.hpp"
+
+// A color only framebuffer and the texture it draws to
+struct RenderTarget {
+    GLuint fbo{0};
+    GLuint texture{0};
+    glm::ivec2 size{0, 0};
+};
+
+// Transient render targets which are handed back once read, so later passes of the same size reuse them
+// Targets are kept between frames, a frame drawing the same passes as the last creates none
+class RenderTargetPool {
+public:
+    RenderTargetPool() = default;
+    ~RenderTargetPool();
+
+    RenderTargetPool(const RenderTargetPool&) = delete;
+    RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+    // Returns a free target of the size, only creating one when none is free
+    RenderTarget acquire(glm::ivec2 size);
+    void release(const RenderTarget& render_target);
+
+    size_t getNumTargets() const;
+
+private:
+    RenderTarget create(glm::ivec2 size);
+
+    std::vector<RenderTarget> targets;
+    std::vector<RenderTarget> free_targets;
+};
\ No newline at end of file
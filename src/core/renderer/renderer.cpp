@@ -1,6 +1,12 @@
 #include "renderer.hpp"
 
+using namespace entt::literals;
+
 Renderer::Renderer() {
+        if (Headless::isEnabled()) {
+            return;
+        }
+
         glClearColor(0.0f, 0.4f, 0.4f, 0.0f);
         glEnable(GL_BLEND); 
         glEnable(GL_STENCIL_TEST);
@@ -10,17 +16,50 @@ Renderer::Renderer() {
         this->initVAO();
         this->initScreenFBOs();
         this->initVBOs();
+        this->initFrameUniforms();
 }
 
 Renderer::~Renderer() {
+    if (Headless::isEnabled()) {
+        return;
+    }
     glDeleteFramebuffers(2, &this->current_screen_fbo);  
     glDeleteFramebuffers(2, &this->other_screen_fbo);  
+    glDeleteBuffers(1, &this->frame_uniforms_ubo);
 }
 
 GLuint Renderer::getScreenTexture() {
     return this->current_screen_texture;
 }
 
+void Renderer::readScreen(std::vector<unsigned char>& pixels) {
+    const size_t row_size = globals::SCREEN_WIDTH*4;
+    pixels.resize(row_size*globals::SCREEN_HEIGHT);
+    if (Headless::isEnabled()) {
+        std::fill(pixels.begin(), pixels.end(), 0);
+        return;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, this->current_screen_fbo);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, globals::SCREEN_WIDTH, globals::SCREEN_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // GL reads from the bottom row up
+    for (int row{0}; row < globals::SCREEN_HEIGHT/2; row++) {
+        std::swap_ranges(
+            pixels.begin() + row*row_size, 
+            pixels.begin() + (row + 1)*row_size, 
+            pixels.begin() + (globals::SCREEN_HEIGHT - row - 1)*row_size
+        );
+    }
+}
+
+const RendererFrameStats& Renderer::getLastFrameStats() const {
+    return this->last_frame_stats;
+}
+
 void Renderer::initVAO() {
     // create vao
     float quad_vertex_data[] = { 
@@ -34,54 +73,88 @@ void Renderer::initVAO() {
         1.0f, 0.0f, 1.0f, 0.0f
     };
     
+    // The verticies will never change, the buffer is shared by every VAO
+    glGenBuffers(1, &this->quad_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, this->quad_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad_vertex_data), quad_vertex_data, GL_STATIC_DRAW);
+
     glGenVertexArrays(1, &(this->vao));
     glBindVertexArray(this->vao);
-    
-    // The verticies will never change so the buffer ID is not saved
-    GLuint vertex_buffer;
-    glGenBuffers(1, &vertex_buffer);
-    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(quad_vertex_data), quad_vertex_data, GL_STATIC_DRAW);
-    
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    this->initQuadAttributes();
+
+    glGenVertexArrays(1, &(this->matrix_vao));
+    glBindVertexArray(this->matrix_vao);
+    this->initQuadAttributes();
+
     // Free bound buffers
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);  
 }
 
+void Renderer::initQuadAttributes() {
+    glBindBuffer(GL_ARRAY_BUFFER, this->quad_vbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+}
+
 void Renderer::initVBOs() {
-    glGenBuffers(1, &(this->texture_coordinates_vbo));
-    glGenBuffers(1, &(this->models_vbo));
+    // The rings grow when a frame queues more than fits, these only avoid doing so on the first frames
+    this->instances_ring.init(4096*sizeof(Instance));
+    this->matrix_instances_ring.init(256*sizeof(MatrixInstance));
 
-    glBindVertexArray(this->vao);
+#ifndef NDEBUG
+    if (!this->instances_ring.isPersistent()) {
+        std::cerr << "Renderer: Persistent buffers are unsupported, orphaning instance buffers instead\n";
+    }
+#endif
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, this->texture_coordinates_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec4) * this->texture_coordinates_buffer_data.size(), this->texture_coordinates_buffer_data.data(), GL_STREAM_DRAW);
-    
+void Renderer::initFrameUniforms() {
+    // Ranges bound to a block must start on the implementation's alignment
+    GLint alignment{0};
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    alignment = std::max(alignment, 1);
+    this->frame_uniforms_stride = (sizeof(FrameUniforms) + alignment - 1)/alignment*alignment;
+    this->frame_uniforms_data.resize(this->frame_uniforms_stride*RenderCommand::MAX_VIEWS);
+
+    glGenBuffers(1, &this->frame_uniforms_ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, this->frame_uniforms_ubo);
+    glBufferData(GL_UNIFORM_BUFFER, this->frame_uniforms_data.size(), NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void Renderer::initInstanceAttributes(GLuint instances_vbo, size_t offset) {
+    glBindBuffer(GL_ARRAY_BUFFER, instances_vbo);
+
+    // Texture data is given to the shader as floats
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_SHORT, GL_FALSE, sizeof(Instance), (void*)(offset + offsetof(Instance, texture_data)));
     glVertexAttribDivisor(1, 1); 
 
-    glBindBuffer(GL_ARRAY_BUFFER, this->models_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(glm::mat4) * this->models_buffer_data.size(), this->texture_coordinates_buffer_data.data(), GL_STREAM_DRAW);
+    // Position and rotation together
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(offset + offsetof(Instance, position)));
+    glVertexAttribDivisor(2, 1); 
 
-    glEnableVertexAttribArray(3); 
-    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(glm::vec4), (void*)0);
-    glEnableVertexAttribArray(4); 
-    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(glm::vec4), (void*)(1 * sizeof(glm::vec4)));
-    glEnableVertexAttribArray(5); 
-    glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(glm::vec4), (void*)(2 * sizeof(glm::vec4)));
-    glEnableVertexAttribArray(6); 
-    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(glm::vec4), (void*)(3 * sizeof(glm::vec4)));
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(offset + offsetof(Instance, size)));
+    glVertexAttribDivisor(3, 1); 
+}
 
-    glVertexAttribDivisor(3, 1);
-    glVertexAttribDivisor(4, 1);
-    glVertexAttribDivisor(5, 1);
-    glVertexAttribDivisor(6, 1);
+void Renderer::initMatrixInstanceAttributes(GLuint matrix_instances_vbo, size_t offset) {
+    glBindBuffer(GL_ARRAY_BUFFER, matrix_instances_vbo);
 
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0); 
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(MatrixInstance), (void*)(offset + offsetof(MatrixInstance, texture_data)));
+    glVertexAttribDivisor(1, 1); 
+
+    // A mat4 takes up four attribute locations
+    for (int column{0}; column < 4; column++) {
+        glEnableVertexAttribArray(3 + column); 
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(MatrixInstance), 
+            (void*)(offset + offsetof(MatrixInstance, model) + column*sizeof(glm::vec4)));
+        glVertexAttribDivisor(3 + column, 1);
+    }
 }
 
 void Renderer::initScreenFBOs() {
@@ -140,89 +213,408 @@ void Renderer::initScreenFBOs() {
     glBindFramebuffer(GL_FRAMEBUFFER, 0); 
 }
 
-void Renderer::bufferData(size_t start, size_t end) {
-    const auto buffer_data_size = end - start;
-    if (this->max_buffer_size < buffer_data_size) {
-        this->max_buffer_size = buffer_data_size;
+void Renderer::bufferData() {
+    const size_t instances_bytes = sizeof(Instance)*this->instances_buffer_data.size();
+    const size_t matrix_instances_bytes = sizeof(MatrixInstance)*this->matrix_instances_buffer_data.size();
 
-        glBindBuffer(GL_ARRAY_BUFFER, this->texture_coordinates_vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec4)*buffer_data_size, &(this->texture_coordinates_buffer_data[start]), GL_DYNAMIC_DRAW);
+    if (instances_bytes > 0) {
+        this->recordBufferUpload(instances_bytes);
+        if (!Headless::isEnabled()) {
+            this->instances_offset = this->instances_ring.upload(this->instances_buffer_data.data(), instances_bytes);
+        }
+    }
+    if (matrix_instances_bytes > 0) {
+        this->recordBufferUpload(matrix_instances_bytes);
+        if (!Headless::isEnabled()) {
+            this->matrix_instances_offset = this->matrix_instances_ring.upload(
+                this->matrix_instances_buffer_data.data(), matrix_instances_bytes
+            );
+        }
+    }
+}
 
-        glBindBuffer(GL_ARRAY_BUFFER, this->models_vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(glm::mat4)*buffer_data_size, &(this->models_buffer_data[start]), GL_DYNAMIC_DRAW);
-    
-    } else {
-        glBindBuffer(GL_ARRAY_BUFFER, this->texture_coordinates_vbo);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(glm::vec4)*buffer_data_size, &(this->texture_coordinates_buffer_data[start]));
+void Renderer::buildBatches() {
+    this->instances_buffer_data.clear();
+    this->matrix_instances_buffer_data.clear();
+    this->batches.clear();
+
+    for (const auto& command : this->commands) {
+        const auto type = RenderCommand::getType(command.key);
+        const uint64_t state = RenderCommand::getState(command.key);
+
+        size_t position{command.index};
+        if (type == RenderCommandType::INSTANCE) {
+            position = this->instances_buffer_data.size();
+            this->instances_buffer_data.push_back(this->queued_instances[command.index]);
+        } else if (type == RenderCommandType::MATRIX_INSTANCE) {
+            position = this->matrix_instances_buffer_data.size();
+            this->matrix_instances_buffer_data.push_back(this->queued_matrix_instances[command.index]);
+        }
 
-        glBindBuffer(GL_ARRAY_BUFFER, this->models_vbo);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(glm::mat4)*buffer_data_size, &(this->models_buffer_data[start]));
+        // Static instances are in their own buffers so can never share a draw
+        if (type != RenderCommandType::STATIC_INSTANCES && !this->batches.empty() && this->batches.back().state == state) {
+            this->batches.back().end++;
+        } else {
+            this->batches.push_back({state, position, position + 1});
+        }
     }
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+void Renderer::recordDraw(size_t num_instances) {
+    this->current_frame_stats.draw_calls++;
+    this->current_frame_stats.instances += num_instances;
+    if (Headless::isEnabled()) {
+        Headless::recordDraw(num_instances);
+    }
+}
+
+void Renderer::recordProgramSwitch() {
+    this->current_frame_stats.program_switches++;
+    if (Headless::isEnabled()) {
+        Headless::recordProgramSwitch();
+    }
+}
+
+void Renderer::recordBufferUpload(size_t num_bytes) {
+    this->current_frame_stats.buffer_uploads++;
+    this->current_frame_stats.buffer_bytes += num_bytes;
+    if (Headless::isEnabled()) {
+        Headless::recordBufferUpload(num_bytes);
+    }
 }
 
 void Renderer::clear() {
+    if (Headless::isEnabled()) {
+        return;
+    }
     glBindFramebuffer(GL_FRAMEBUFFER, this->current_screen_fbo);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
     glBindFramebuffer(GL_FRAMEBUFFER, this->other_screen_fbo);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 }
 
-void Renderer::queue(const glm::vec4& texture_data, const glm::mat4& model_data, ShaderProgram* shader_program) {
-    this->texture_coordinates_buffer_data.push_back(texture_data);
-    this->models_buffer_data.push_back(model_data);
-    this->shader_programs.push_back(shader_program);
+
+void Renderer::setView(uint8_t view, const RenderView& render_view) {
+    this->views[view] = render_view;
+    this->num_views = std::max(this->num_views, (size_t)view + 1);
 }
 
-void Renderer::render() {
-    size_t start = 0, end = 0;
-    ShaderProgram* last_shader{this->shader_programs[0]};
-    ShaderProgram* next_shader;
-    while (++end < this->shader_programs.size()) {
-        next_shader = this->shader_programs[end];
-        if (this->shader_programs[end] != last_shader) {
-            this->renderPartialBuffer(start, end, last_shader);
-            start = end;
+void Renderer::setFrameUniforms(const glm::vec2& atlas_dimensions, float time) {
+    this->atlas_dimensions = atlas_dimensions;
+    this->time = time;
+}
+
+void Renderer::bufferFrameUniforms() {
+    const size_t num_views = std::max(this->num_views, (size_t)1);
+    const size_t num_bytes = this->frame_uniforms_stride*num_views;
+    this->recordBufferUpload(num_bytes);
+    if (Headless::isEnabled()) {
+        return;
+    }
+
+    for (size_t view{0}; view < num_views; view++) {
+        const RenderView& render_view = this->views[view];
+        const FrameUniforms frame_uniforms{
+            render_view.projection,
+            render_view.view,
+            this->atlas_dimensions,
+            glm::vec2(globals::SCREEN_WIDTH, globals::SCREEN_HEIGHT),
+            render_view.zoom,
+            this->time
+        };
+        memcpy(&this->frame_uniforms_data[view*this->frame_uniforms_stride], &frame_uniforms, sizeof(FrameUniforms));
+    }
+
+    // Orphaned first so the upload never waits on last frame's draws
+    glBindBuffer(GL_UNIFORM_BUFFER, this->frame_uniforms_ubo);
+    glBufferData(GL_UNIFORM_BUFFER, this->frame_uniforms_data.size(), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, num_bytes, this->frame_uniforms_data.data());
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    this->bound_view = -1;
+    this->bindView(0);
+}
+
+void Renderer::bindView(uint8_t view) {
+    if (this->bound_view == view || Headless::isEnabled()) {
+        return;
+    }
+    this->bound_view = view;
+    glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_UNIFORMS_BINDING, this->frame_uniforms_ubo, 
+        view*this->frame_uniforms_stride, sizeof(FrameUniforms));
+}
+
+uint8_t Renderer::getShaderId(ShaderProgram* shader_program) {
+    // Consecutive commands almost always use the same shader
+    if (shader_program == this->last_queued_shader_program) {
+        return this->last_queued_shader_id;
+    }
+
+    auto found = std::find(this->shader_programs.begin(), this->shader_programs.end(), shader_program);
+    if (found == this->shader_programs.end()) {
+        assert(this->shader_programs.size() < RenderCommand::MAX_SHADERS && "More shaders were queued than a render key can hold.");
+        if (this->shader_programs.size() >= RenderCommand::MAX_SHADERS) {
+            // The shader is left out so every id stays in range, its commands are drawn with the first shader instead
+            std::cerr << "ERROR: Renderer: More than " << RenderCommand::MAX_SHADERS << " shaders were queued\n";
+            return 0;
         }
-        last_shader = next_shader;
+        found = this->shader_programs.insert(found, shader_program);
+    }
+
+    this->last_queued_shader_program = shader_program;
+    this->last_queued_shader_id = std::distance(this->shader_programs.begin(), found);
+    return this->last_queued_shader_id;
+}
+
+void Renderer::queue(const Instance& instance, ShaderProgram* shader_program, const RenderKey& key) {
+    this->commands.push_back({
+        RenderCommand::makeKey(key, this->getShaderId(shader_program), RenderCommandType::INSTANCE), 
+        (uint32_t)this->queued_instances.size()
+    });
+    this->queued_instances.push_back(instance);
+}
+
+void Renderer::queue(const glm::vec4& texture_data, const glm::mat4& model_data, ShaderProgram* shader_program, const RenderKey& key) {
+    this->commands.push_back({
+        RenderCommand::makeKey(key, this->getShaderId(shader_program), RenderCommandType::MATRIX_INSTANCE), 
+        (uint32_t)this->queued_matrix_instances.size()
+    });
+    this->queued_matrix_instances.push_back({texture_data, model_data});
+}
+
+void Renderer::queue(const StaticInstances& instances, ShaderProgram* shader_program, const RenderKey& key) {
+    if (instances.count == 0) {
+        return;
+    }
+    this->commands.push_back({
+        RenderCommand::makeKey(key, this->getShaderId(shader_program), RenderCommandType::STATIC_INSTANCES), 
+        (uint32_t)this->queued_static_instances.size()
+    });
+    this->queued_static_instances.push_back(&instances);
+}
+
+void Renderer::render() {
+    radixSort(this->commands, this->commands_scratch, [](const RenderCommand& command) {
+        return command.key;
+    });
+    this->buildBatches();
+    this->bufferData();
+    // Bound to view 0 even when nothing is queued, the screen shaders read the shared values from it
+    this->bufferFrameUniforms();
+
+    this->last_shader_program = nullptr;
+    for (const auto& batch : this->batches) {
+        this->renderBatch(batch);
     }
-    this->renderPartialBuffer(start, this->models_buffer_data.size(), last_shader);
+    this->setStencilState(StencilState::NONE);
     
-    this->texture_coordinates_buffer_data.clear();
-    this->models_buffer_data.clear();
-    this->shader_programs.clear();
+    this->commands.clear();
+    this->queued_instances.clear();
+    this->queued_matrix_instances.clear();
+    this->queued_static_instances.clear();
+}
+
+void Renderer::uploadStaticInstances(StaticInstances& instances, const std::vector<Instance>& instance_data) {
+    instances.count = instance_data.size();
+    instances.is_uploaded = true;
+
+    this->recordBufferUpload(sizeof(Instance)*instance_data.size());
+    if (Headless::isEnabled()) {
+        return;
+    }
+
+    glGenVertexArrays(1, &instances.vao);
+    glGenBuffers(1, &instances.instances_vbo);
+
+    glBindVertexArray(instances.vao);
+    this->initQuadAttributes();
+
+    glBindBuffer(GL_ARRAY_BUFFER, instances.instances_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Instance)*instance_data.size(), instance_data.data(), GL_STATIC_DRAW);
+    this->initInstanceAttributes(instances.instances_vbo);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+void Renderer::releaseStaticInstances(StaticInstances& instances) {
+    if (!Headless::isEnabled() && instances.is_uploaded) {
+        glDeleteBuffers(1, &instances.instances_vbo);
+        glDeleteVertexArrays(1, &instances.vao);
+    }
+    instances = StaticInstances();
+}
+
+
+
+void Renderer::setStencilState(StencilState stencil_state) {
+    if (stencil_state == this->stencil_state) {
+        return;
+    }
+    this->stencil_state = stencil_state;
+    if (Headless::isEnabled()) {
+        return;
+    }
+
+    switch (stencil_state) {
+        case StencilState::WRITE:
+            glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE); // Do not draw any pixels on the back buffer
+            glEnable(GL_STENCIL_TEST); 
+            glStencilFunc(GL_ALWAYS, 1, 0xFF); // Do not test the current value in the stencil buffer, always accept any value on there for drawing
+            glStencilMask(0xFF);
+            glStencilOp(GL_REPLACE, GL_REPLACE, GL_REPLACE); // Make every test succeed
+            break;
+        case StencilState::TEST:
+            glEnable(GL_STENCIL_TEST); 
+            glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP); // Make sure you will no longer (over)write stencil values, even if any test succeeds
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE); // Make sure we draw on the backbuffer again.
+            glStencilFunc(GL_EQUAL, 1, 0xFF); // Now we will only draw pixels where the corresponding stencil buffer value equals 1
+            break;
+        case StencilState::NONE:
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+            glDisable(GL_STENCIL_TEST);
+            break;
+    }
 }
 
 void Renderer::present(ShaderProgram* shader_program) {
+    this->recordDraw(1);
+    this->last_frame_stats = this->current_frame_stats;
+    this->current_frame_stats = RendererFrameStats();
+    if (Headless::isEnabled()) {
+        return;
+    }
     // Render to screen
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    shader_program->setUniform("screen_texture", this->current_screen_texture);
+    shader_program->setUniform("screen_texture"_hs, this->current_screen_texture);
     shader_program->render(6, this->vao, 0);
 
     glUseProgram(0);
     glBindVertexArray(0);
+
+    // Every draw reading this frame's instances has been submitted
+    this->instances_ring.endFrame();
+    this->matrix_instances_ring.endFrame();
 }
 
-void Renderer::renderPartialBuffer(size_t start, size_t end, ShaderProgram* shader_program) {
-    this->bufferData(start, end);
+void Renderer::renderBatch(const Batch& batch) {
+    const auto type = RenderCommand::getType(batch.state);
+    ShaderProgram* shader_program = this->shader_programs[RenderCommand::getShaderId(batch.state)];
+    const StaticInstances* static_instances = type == RenderCommandType::STATIC_INSTANCES ? 
+        this->queued_static_instances[batch.start] : nullptr;
+    const size_t num_instances = static_instances ? static_instances->count : batch.end - batch.start;
 
-    shader_program->setUniform("screen_texture", this->other_screen_texture);
-    shader_program->render(end - start, this->vao, this->current_screen_fbo);
+    if (shader_program != this->last_shader_program) {
+        this->last_shader_program = shader_program;
+        this->recordProgramSwitch();
+    }
+    this->recordDraw(num_instances);
+    this->setStencilState(RenderCommand::getStencil(batch.state));
+    if (Headless::isEnabled()) {
+        return;
+    }
+
+    GLuint batch_vao{this->vao};
+    if (type == RenderCommandType::STATIC_INSTANCES) {
+        batch_vao = static_instances->vao;
+        shader_program->setUniform("atlas_offset"_hs, static_instances->atlas_offset);
+    } else {
+        // Batches share one upload, so the attributes are pointed at where this batch starts in it
+        //  instead of drawing with a base instance, which GL 3.2 does not have
+        const bool is_matrix = type == RenderCommandType::MATRIX_INSTANCE;
+        batch_vao = is_matrix ? this->matrix_vao : this->vao;
+        glBindVertexArray(batch_vao);
+        if (is_matrix) {
+            this->initMatrixInstanceAttributes(
+                this->matrix_instances_ring.getBuffer(), 
+                this->matrix_instances_offset + batch.start*sizeof(MatrixInstance)
+            );
+        } else {
+            this->initInstanceAttributes(
+                this->instances_ring.getBuffer(), 
+                this->instances_offset + batch.start*sizeof(Instance)
+            );
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    this->bindView(RenderCommand::getView(batch.state));
+    shader_program->setUniform("screen_texture"_hs, this->other_screen_texture);
+    shader_program->render(num_instances, batch_vao, this->current_screen_fbo);
 }
 
-void Renderer::renderPostProcessing(ShaderProgram* shader_program) {
+void Renderer::renderPostProcessing(const PostProcessChain& post_process_chain) {
+    const auto& passes = post_process_chain.getPasses();
+    const glm::ivec2 screen_size{globals::SCREEN_WIDTH, globals::SCREEN_HEIGHT};
+
+    size_t last_pass{passes.size()};
+    for (size_t pass{0}; pass < passes.size(); pass++) {
+        if (passes[pass].is_enabled) {
+            last_pass = pass;
+        }
+    }
+    if (last_pass == passes.size()) {
+        return;
+    }
+
+    // Each pass reads the one before it, the source is handed back to the pool once it has been read
+    RenderTarget source{this->current_screen_fbo, this->current_screen_texture, screen_size};
+    bool is_source_pooled{false};
+    for (size_t pass{0}; pass <= last_pass; pass++) {
+        if (!passes[pass].is_enabled) {
+            continue;
+        }
+        const glm::ivec2 size = post_process_chain.getPassSize(pass);
+        // A full resolution last pass draws straight into the screen buffer
+        const bool is_to_screen = pass == last_pass && size == screen_size;
+        const RenderTarget destination = is_to_screen ? 
+            RenderTarget{this->other_screen_fbo, this->other_screen_texture, screen_size} : 
+            this->render_targets.acquire(size);
+
+        this->recordDraw(1);
+        if (!Headless::isEnabled()) {
+            glBindFramebuffer(GL_FRAMEBUFFER, destination.fbo);
+            glViewport(0, 0, size.x, size.y);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            ShaderProgram* shader_program = passes[pass].shader_program;
+            shader_program->setUniform("screen_texture"_hs, source.texture);
+            shader_program->render(6, this->vao, destination.fbo);
+        }
+
+        if (is_source_pooled) {
+            this->render_targets.release(source);
+        }
+        source = destination;
+        is_source_pooled = !is_to_screen;
+    }
+
+    if (is_source_pooled) {
+        // The last pass was drawn at a lower resolution, so it is scaled back up into the screen buffer
+        if (!Headless::isEnabled()) {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, source.fbo);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->other_screen_fbo);
+            glBlitFramebuffer(
+                0, 0, source.size.x, source.size.y, 
+                0, 0, screen_size.x, screen_size.y, 
+                GL_COLOR_BUFFER_BIT, GL_LINEAR
+            );
+        }
+        this->render_targets.release(source);
+    }
+
     std::swap(this->current_screen_fbo, this->other_screen_fbo);
     std::swap(this->current_screen_texture, this->other_screen_texture);
+    if (Headless::isEnabled()) {
+        return;
+    }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, this->current_screen_fbo);
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    shader_program->setUniform("screen_texture", this->other_screen_texture);
-    shader_program->render(6, this->vao, this->current_screen_fbo);
-    
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, screen_size.x, screen_size.y);
     glUseProgram(0);
     glBindVertexArray(0);
 }
\ No newline at end of file
@@ -1,11 +1,34 @@
 #include <vector>
+#include <array>
+#include <algorithm>
+#include <iterator>
+#include <cstddef>
 #include <iostream>
+#include <cassert>
 
 #include "globals.hpp"
 #include "shader_program.hpp"
+#include "frame_uniforms.hpp"
 #include "clock.hpp"
 #include "camera.hpp"
 #include "texture_atlas.hpp"
+#include "headless.hpp"
+#include "static_instances.hpp"
+#include "instance.hpp"
+#include "instance_ring.hpp"
+#include "render_target_pool.hpp"
+#include "post_process_chain.hpp"
+#include "render_command.hpp"
+#include "radix_sort.hpp"
+
+// Work submitted to the GPU by the renderer over a frame
+struct RendererFrameStats {
+    size_t draw_calls{0};
+    size_t instances{0};
+    size_t program_switches{0};
+    size_t buffer_uploads{0};
+    size_t buffer_bytes{0};
+};
 
 class Renderer {
 public:
@@ -13,42 +36,115 @@ public:
     ~Renderer();
 
     void clear();
+    // Commands drawn with the view are given its camera uniforms
+    void setView(uint8_t view, const RenderView& render_view);
+    // Uniforms which are the same for every view, uploaded with them on the next render
+    void setFrameUniforms(const glm::vec2& atlas_dimensions, float time);
+    void queue(const Instance& instance, ShaderProgram* shader_program, const RenderKey& key);
+    // For quads which need a full model matrix, the shader must take one
     void queue(
         const glm::vec4& texture_data, 
         const glm::mat4& model_data,
-        ShaderProgram* shader_program
+        ShaderProgram* shader_program,
+        const RenderKey& key
     );
+    // Static instances are drawn from their own buffer, which must outlive the next render
+    void queue(const StaticInstances& instances, ShaderProgram* shader_program, const RenderKey& key);
+    // Sorts everything queued by key and draws it, merging consecutive commands with the same state
     void render();
 
-    void renderPostProcessing(ShaderProgram* shader_program);
+    // Static instances are uploaded once and queued every frame without copying their instances
+    void uploadStaticInstances(StaticInstances& instances, const std::vector<Instance>& instance_data);
+    void releaseStaticInstances(StaticInstances& instances);
+
+    // Draws the enabled passes of the chain over the rendered scene, leaving the result in the screen buffer
+    void renderPostProcessing(const PostProcessChain& post_process_chain);
     void present(ShaderProgram* shader_program);
 
     GLuint getScreenTexture();
+    // Reads back the last presented frame as RGBA, top row first
+    void readScreen(std::vector<unsigned char>& pixels);
+    const RendererFrameStats& getLastFrameStats() const;
 
 private:
     void initVAO();
     void initVBOs();
+    void initFrameUniforms();
+    void initQuadAttributes();
+    // Point the instance attributes of the bound VAO at the buffer, starting offset bytes in
+    void initInstanceAttributes(GLuint instances_vbo, size_t offset = 0);
+    void initMatrixInstanceAttributes(GLuint matrix_instances_vbo, size_t offset = 0);
     void initScreenFBOs();
     void initPixelPassFBO();
     void initFinalFBO();
 
-    void bufferData(size_t start, size_t end);
-    void renderPartialBuffer(size_t start, size_t end, ShaderProgram* shader_program);
+    // Consecutive sorted commands with the same state, drawn with one call
+    // The range is into the sorted instances of the state's type, or the static instances queued
+    struct Batch {
+        uint64_t state;
+        size_t start;
+        size_t end;
+    };
 
-    
-    GLuint vao;
-    GLuint current_screen_fbo;
-    GLuint other_screen_fbo;
-    GLuint current_screen_texture;
-    GLuint other_screen_texture;
+    uint8_t getShaderId(ShaderProgram* shader_program);
+    // Gathers the instances in sorted order while merging the commands into batches
+    void buildBatches();
+    // Uploads every instance queued since the last render in one write per buffer
+    void bufferData();
+    void bufferFrameUniforms();
+    void bindView(uint8_t view);
+    void renderBatch(const Batch& batch);
+    // Lets the stencil buffer mask out everything drawn under TEST which was not covered by something drawn under WRITE
+    void setStencilState(StencilState stencil_state);
+    void recordDraw(size_t num_instances);
+    void recordProgramSwitch();
+    void recordBufferUpload(size_t num_bytes);
 
-    GLuint texture_coordinates_vbo;
-    std::vector<glm::vec4> texture_coordinates_buffer_data; 
+    
+    GLuint vao{0};
+    GLuint matrix_vao{0};
+    GLuint quad_vbo{0};
+    GLuint current_screen_fbo{0};
+    GLuint other_screen_fbo{0};
+    GLuint current_screen_texture{0};
+    GLuint other_screen_texture{0};
 
-    GLuint models_vbo;
-    std::vector<glm::mat4> models_buffer_data;
+    std::vector<RenderCommand> commands;
+    std::vector<RenderCommand> commands_scratch;
+    std::vector<Instance> queued_instances;
+    std::vector<MatrixInstance> queued_matrix_instances;
+    std::vector<const StaticInstances*> queued_static_instances;
 
+    // Shader ids in the keys index into this, a shader keeps its id for the lifetime of the renderer
     std::vector<ShaderProgram*> shader_programs;
+    ShaderProgram* last_queued_shader_program{nullptr};
+    uint8_t last_queued_shader_id{0};
+    std::array<RenderView, RenderCommand::MAX_VIEWS> views;
+    size_t num_views{0};
+    glm::vec2 atlas_dimensions{0.0f};
+    float time{0.0f};
+
+    // One FrameUniforms per view, each range is bound to the block while drawing with that view
+    GLuint frame_uniforms_ubo{0};
+    size_t frame_uniforms_stride{sizeof(FrameUniforms)};
+    std::vector<char> frame_uniforms_data;
+    int bound_view{-1};
+
+    InstanceRing instances_ring;
+    std::vector<Instance> instances_buffer_data;
+    size_t instances_offset{0};
+
+    InstanceRing matrix_instances_ring;
+    std::vector<MatrixInstance> matrix_instances_buffer_data;
+    size_t matrix_instances_offset{0};
+
+    // Transient targets for post processing passes which do not draw straight into the screen buffer
+    RenderTargetPool render_targets;
+
+    std::vector<Batch> batches;
+    ShaderProgram* last_shader_program{nullptr};
+    StencilState stencil_state{StencilState::NONE};
 
-    size_t max_buffer_size{0}; 
+    RendererFrameStats current_frame_stats;
+    RendererFrameStats last_frame_stats;
 };
\ No newline at end of file
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <GL\glew.h>
+
+#include <glm/glm.hpp>
+
+// Instance data uploaded once and drawn as is every frame
+struct StaticInstances {
+    GLuint vao{0};
+    GLuint instances_vbo{0};
+    size_t count{0};
+    // Added to the texture position of every instance, moving them all through an animation together
+    // Like the instance positions, x carries the atlas layer packed above it
+    glm::vec2 atlas_offset{0.0f};
+    bool is_uploaded{false};
+};
\ No newline at end of file
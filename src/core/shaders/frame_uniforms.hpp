@@ -0,0 +1,23 @@
+#pragma once
+
+#include <GL\glew.h>
+
+#include <glm/glm.hpp>
+
+// Uniforms shared by every shader, uploaded to a uniform buffer once per frame for each view
+// Must match the std140 FrameUniforms block declared in the shaders
+struct FrameUniforms {
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::vec2 atlas_dimensions;
+    glm::vec2 screen_resolution;
+    float camera_zoom;
+    float time;
+    // std140 rounds the block up to a multiple of a vec4
+    float padding[2]{0.0f, 0.0f};
+};
+
+static_assert(sizeof(FrameUniforms) == 160, "FrameUniforms must match the std140 layout of the block");
+
+const char* const FRAME_UNIFORMS_BLOCK_NAME{"FrameUniforms"};
+constexpr GLuint FRAME_UNIFORMS_BINDING{0};
\ No newline at end of file
@@ -13,6 +13,8 @@
 
 #include <GL/glew.h>
 
+#include "mapped_file.hpp"
+#include "asset_load_stats.hpp"
 
 GLuint LoadShaders(const char * vertex_file_path, const char * fragment_file_path, std::vector<std::string>& logs){
 
@@ -23,18 +25,10 @@ GLuint LoadShaders(const char * vertex_file_path, const char * fragment_file_pat
 	GLuint vertex_shader_id = glCreateShader(GL_VERTEX_SHADER);
 	GLuint fragment_shader_id = glCreateShader(GL_FRAGMENT_SHADER);
 
-	// Read the Vertex Shader code from the file
-	std::string vertex_shader_source;
-	std::ifstream vertex_shader_stream(vertex_file_path, std::ios::in);
+	// Map the Vertex Shader code from the file, it is passed to GL without being copied
+	MappedFile vertex_shader_file(vertex_file_path);
 
-	if(vertex_shader_stream.is_open()){
-
-		std::stringstream sstr;
-		sstr << vertex_shader_stream.rdbuf();
-		vertex_shader_source = sstr.str();
-		vertex_shader_stream.close();
-
-	}else{
+	if(!vertex_shader_file.isOpen()){
 
 		#ifndef NDEBUG
 			log_stream << "[error]:  Unable to load vertex shader source: " << vertex_file_path << "\n";
@@ -47,16 +41,20 @@ GLuint LoadShaders(const char * vertex_file_path, const char * fragment_file_pat
 		return 0;
 	}
 
-	// Read the Fragment Shader code from the file
-	std::string fragment_shader_source;
-	std::ifstream fragment_shader_stream(fragment_file_path, std::ios::in);
+	// Map the Fragment Shader code from the file
+	MappedFile fragment_shader_file(fragment_file_path);
+
+	if(!fragment_shader_file.isOpen()){
 
-	if(fragment_shader_stream.is_open()){
+		#ifndef NDEBUG
+			log_stream << "[error]:  Unable to load fragment shader source: " << fragment_file_path << "\n";
+			logs.push_back(log_stream.str());
+			log_stream.str(std::string());
+		#endif
 
-		std::stringstream sstr;
-		sstr << fragment_shader_stream.rdbuf();
-		fragment_shader_source = sstr.str();
-		fragment_shader_stream.close();
+		getchar();
+		
+		return 0;
 	}
 
 	#ifndef NDEBUG
@@ -75,9 +73,15 @@ GLuint LoadShaders(const char * vertex_file_path, const char * fragment_file_pat
 		log_stream.str(std::string());
 	#endif
 
-	char const * vertex_source_pointer = vertex_shader_source.c_str();
-	glShaderSource(vertex_shader_id, 1, &vertex_source_pointer , NULL);
-	glCompileShader(vertex_shader_id);
+	// The mapped sources are not null terminated, so their lengths are passed along with them
+	// Mapping a shader costs next to nothing, so its record holds the time spent compiling it
+	{
+		AssetLoadTimer load_timer(std::string(vertex_file_path) + " (compile)", vertex_shader_file.size());
+		char const * vertex_source_pointer = reinterpret_cast<const char*>(vertex_shader_file.data());
+		GLint vertex_source_length = static_cast<GLint>(vertex_shader_file.size());
+		glShaderSource(vertex_shader_id, 1, &vertex_source_pointer , &vertex_source_length);
+		glCompileShader(vertex_shader_id);
+	}
 
 	#ifndef NDEBUG
 
@@ -107,9 +111,13 @@ GLuint LoadShaders(const char * vertex_file_path, const char * fragment_file_pat
 		log_stream.str(std::string());
 	#endif
 
-	char const * fragment_source_pointer = fragment_shader_source.c_str();
-	glShaderSource(fragment_shader_id, 1, &fragment_source_pointer , NULL);
-	glCompileShader(fragment_shader_id);
+	{
+		AssetLoadTimer load_timer(std::string(fragment_file_path) + " (compile)", fragment_shader_file.size());
+		char const * fragment_source_pointer = reinterpret_cast<const char*>(fragment_shader_file.data());
+		GLint fragment_source_length = static_cast<GLint>(fragment_shader_file.size());
+		glShaderSource(fragment_shader_id, 1, &fragment_source_pointer , &fragment_source_length);
+		glCompileShader(fragment_shader_id);
+	}
 
 	#ifndef NDEBUG
 
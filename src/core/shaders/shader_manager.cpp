@@ -17,6 +17,16 @@ ShaderManager::ShaderManager(entt::registry& registry) {
         "./src/systems/render/shaders/instanced/vertex.glsl",
         "./src/systems/render/shaders/instanced/fragment.glsl"
     );
+    this->shaders["instanced_matrix"] = this->simpleInstancedShader(
+        registry,
+        "./src/systems/render/shaders/instanced_matrix/vertex.glsl",
+        "./src/systems/render/shaders/instanced_matrix/fragment.glsl"
+    );
+    this->shaders["instanced_tile_chunk"] = this->simpleInstancedShader(
+        registry,
+        "./src/systems/render/shaders/instanced_tile_chunk/vertex.glsl",
+        "./src/systems/render/shaders/instanced_tile_chunk/fragment.glsl"
+    );
     this->shaders["instanced_other"] = this->simpleInstancedShader(
         registry,
         "./src/systems/render/shaders/instanced_other/vertex.glsl",
@@ -62,7 +72,7 @@ ShaderProgram* ShaderManager::simpleInstancedShader(entt::registry& registry, co
         //     {UniformDataType::MAT_4X4, "V"},
         //     {UniformDataType::MAT_4X4, "P"},
         //     {UniformDataType::FLOAT, "camera_zoom"},
-        //     {UniformDataType::TEX_2D, "atlas_texture"}
+        //     {UniformDataType::TEX_2D_ARRAY, "atlas_texture"}
         // },
         vertex_source,
         fragment_source,
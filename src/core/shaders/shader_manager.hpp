@@ -18,11 +18,13 @@ struct ShaderManager {
     ShaderProgram* simpleInstancedShader(entt::registry& registry, const char* vertex_source, const char* fragment_source);
     ShaderProgram* simpleScreenShader(entt::registry& registry, const char* vertex_source, const char* fragment_source);
     template <typename T>
-    void setAllUniforms(const char* uniform_name, T uniform_data) {
+    void setAllUniforms(entt::id_type uniform_id, T uniform_data) {
         for (auto [name, shader] : this->shaders) {
-            shader->setUniform(uniform_name, uniform_data);
+            shader->setUniform(uniform_id, uniform_data);
         }
     }
+    // Looks the shader up by name, callers drawing every frame should keep the returned pointer
+    //  the program is recompiled in place so it stays valid
     ShaderProgram*& operator[](const char* shader_name);
     std::unordered_map<std::string, ShaderProgram*> shaders;
     std::vector<std::string> logs;
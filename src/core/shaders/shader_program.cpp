@@ -5,8 +5,11 @@ ShaderProgram::ShaderProgram(
     const char* fragment_source, 
     std::vector<std::string>& logs
 ) : logs{logs}, vertex_source{vertex_source}, fragment_source{fragment_source} {
-    this->id = LoadShaders(this->vertex_source, this->fragment_source, this->logs);
-    this->getUniforms();
+    // Without a GL context the program has no uniforms, setUniform calls will find nothing to set
+    if (!Headless::isEnabled()) {
+        this->id = LoadShaders(this->vertex_source, this->fragment_source, this->logs);
+        this->getUniforms();
+    }
     this->initUniformBuffer();
 }
 
@@ -15,8 +18,18 @@ ShaderProgram::~ShaderProgram() {
 }
 
 void ShaderProgram::use(){ 
+    if (Headless::isEnabled()) {
+        return;
+    }
     glUseProgram(this->id); 
-    for (auto uniform : this->uniforms) {
+    for (auto& uniform : this->uniforms) {
+        // Uniform values are kept by the program, but textures are bound to the shared texture unit
+        const bool is_texture = uniform.type == UniformDataType::TEX_2D || uniform.type == UniformDataType::TEX_2D_ARRAY;
+        if (!uniform.is_dirty && !is_texture) {
+            continue;
+        }
+        uniform.is_dirty = false;
+
         switch(uniform.type) {
             case UniformDataType::INT:
                 glUniform1i(
@@ -113,6 +126,13 @@ void ShaderProgram::use(){
                     *reinterpret_cast<GLuint*>(this->uniform_buffer + uniform.buffer_offset)
                 );
                 break;
+            case UniformDataType::TEX_2D_ARRAY:
+                // The array texture sets its own filtering
+                glBindTexture(
+                    GL_TEXTURE_2D_ARRAY, 
+                    *reinterpret_cast<GLuint*>(this->uniform_buffer + uniform.buffer_offset)
+                );
+                break;
             default:
                 break;
         }
@@ -120,6 +140,9 @@ void ShaderProgram::use(){
 };
 
 void ShaderProgram::render(size_t num_verts, GLuint vao, GLuint dest_fbo){ 
+    if (Headless::isEnabled()) {
+        return;
+    }
     glBindFramebuffer(GL_FRAMEBUFFER, dest_fbo);
     this->use();
     glBindVertexArray(vao);
@@ -127,6 +150,9 @@ void ShaderProgram::render(size_t num_verts, GLuint vao, GLuint dest_fbo){
 };
 
 void ShaderProgram::recompile() {
+    if (Headless::isEnabled()) {
+        return;
+    }
     glDeleteShader(this->id);
     free(this->uniform_buffer);
     this->uniforms.clear();
@@ -135,91 +161,32 @@ void ShaderProgram::recompile() {
     this->initUniformBuffer();
 }
 
-bool ShaderProgram::containsUniform(const char* name) {
-    for (auto uniform : this->uniforms) {
-        if (!strcmp(uniform.name.c_str(), name)) {
+bool ShaderProgram::containsUniform(entt::id_type id) {
+    for (const auto& uniform : this->uniforms) {
+        if (uniform.id == id) {
             return true;
         }
     }
     return false;
 }
 
-void ShaderProgram::setUniformBufferData(size_t offset, GLint uniform_data) {
-    *reinterpret_cast<GLint*>(this->uniform_buffer + offset) = uniform_data;
-}
-
-void ShaderProgram::setUniformBufferDataV(size_t offset, size_t count, GLint* uniform_data) {
-    memcpy(
-        reinterpret_cast<GLint*>(this->uniform_buffer + offset), 
-        uniform_data,
-        count
-    );
-}
-
-void ShaderProgram::setUniformBufferData(size_t offset, GLfloat uniform_data) {
-    *reinterpret_cast<GLfloat*>(this->uniform_buffer + offset) = uniform_data;
-}
-
-void ShaderProgram::setUniformBufferDataV(size_t offset, size_t count, float* uniform_data) {
-    memcpy(
-        reinterpret_cast<GLfloat*>(this->uniform_buffer + offset), 
-        uniform_data,
-        count
-    );
-}
-
-void ShaderProgram::setUniformBufferData(size_t offset, glm::vec2 uniform_data) {
-    *reinterpret_cast<glm::vec2*>(this->uniform_buffer + offset) = uniform_data;
-}
-
-void ShaderProgram::setUniformBufferDataV(size_t offset, size_t count, glm::vec2* uniform_data) {
-    memcpy(
-        reinterpret_cast<glm::vec2*>(this->uniform_buffer + offset), 
-        uniform_data,
-        count
-    );
-}
-
-void ShaderProgram::setUniformBufferData(size_t offset, glm::vec3 uniform_data) {
-    *reinterpret_cast<glm::vec3*>(this->uniform_buffer + offset) = uniform_data;
-}
-
-void ShaderProgram::setUniformBufferDataV(size_t offset, size_t count, glm::vec3* uniform_data) {
-    memcpy(
-        reinterpret_cast<glm::vec3*>(this->uniform_buffer + offset), 
-        uniform_data,
-        count
-    );
-}
- 
-void ShaderProgram::setUniformBufferData(size_t offset, glm::vec4 uniform_data) {
-    *reinterpret_cast<glm::vec4*>(this->uniform_buffer + offset) = uniform_data;
-}
-
-void ShaderProgram::setUniformBufferDataV(size_t offset, size_t count, glm::vec4* uniform_data) {
-    memcpy(
-        reinterpret_cast<glm::vec4*>(this->uniform_buffer + offset), 
-        uniform_data,
-        count
-    );
-}
- 
-void ShaderProgram::setUniformBufferData(size_t offset, glm::mat4 uniform_data) {
-    *reinterpret_cast<glm::mat4*>(this->uniform_buffer + offset) = uniform_data;
+void ShaderProgram::markUniformsDirty() {
+    for (auto& uniform : this->uniforms) {
+        uniform.is_dirty = true;
+    }
 }
 
-void ShaderProgram::setUniformBufferDataV(size_t offset, size_t count, glm::mat4* uniform_data) {
-    memcpy(
-        reinterpret_cast<glm::mat4*>(this->uniform_buffer + offset), 
-        uniform_data,
-        count
-    );
-}
+void ShaderProgram::setUniformBufferData(Uniform& uniform, const void* uniform_data, size_t num_bytes) {
+    const auto type_info{UNIFORM_TYPE_INFO[static_cast<size_t>(uniform.type)]};
+    const size_t uniform_size = type_info.is_array_type ? type_info.size*uniform.array_size : type_info.size;
+    num_bytes = std::min(num_bytes, uniform_size);
 
-void ShaderProgram::setUniformBufferData(size_t offset, GLuint uniform_data) {
-    *reinterpret_cast<GLuint*>(this->uniform_buffer + offset) = uniform_data;
+    char* destination = this->uniform_buffer + uniform.buffer_offset;
+    if (memcmp(destination, uniform_data, num_bytes) != 0) {
+        memcpy(destination, uniform_data, num_bytes);
+        uniform.is_dirty = true;
+    }
 }
- 
 
 void ShaderProgram::initUniformBuffer() {
     size_t buffer_size{0};
@@ -282,11 +249,22 @@ void ShaderProgram::getUniforms() {
             &name[0]
         );
 
-        this->uniforms.emplace_back(
+        // Uniforms in a block have no location, they are set through the block's buffer
+        if (values[3] == -1) {
+            continue;
+        }
+
+        auto& added_uniform = this->uniforms.emplace_back(
             convertGLType(values[1], values[2] > 1), 
             std::string(name.begin(), name.end()), 
             values[2], 
             values[3]
         );
+        added_uniform.id = entt::hashed_string::value(added_uniform.name.c_str());
+    }
+
+    const GLuint block_index = glGetUniformBlockIndex(this->id, FRAME_UNIFORMS_BLOCK_NAME);
+    if (block_index != GL_INVALID_INDEX) {
+        glUniformBlockBinding(this->id, block_index, FRAME_UNIFORMS_BINDING);
     }
 }
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include <vector>
 #include <functional>
 #include <string>
+#include <type_traits>
+#include <algorithm>
+#include <cstring>
 
 // GLEW must come before OpenGL
 #include <GL\glew.h>
@@ -11,8 +14,23 @@
 
 #include <glm/glm.hpp>
 
+#include <entt/core/hashed_string.hpp>
+
 #include "uniform.hpp"
+#include "frame_uniforms.hpp"
 #include "shader_loader.hpp"
+#include "headless.hpp"
+
+// Types which can be given to setUniform, matching the types the uniform buffer stores
+template<typename T>
+constexpr bool is_uniform_type_v = 
+    std::is_same_v<T, GLint> || 
+    std::is_same_v<T, GLuint> || 
+    std::is_same_v<T, GLfloat> || 
+    std::is_same_v<T, glm::vec2> || 
+    std::is_same_v<T, glm::vec3> || 
+    std::is_same_v<T, glm::vec4> || 
+    std::is_same_v<T, glm::mat4>;
 
 class ShaderProgram {
 public:
@@ -25,32 +43,24 @@ public:
     void use();
     void render(size_t num_verts, GLuint vao, GLuint dest_fbo);
     void recompile();
-    bool containsUniform(const char* name);
+    bool containsUniform(entt::id_type id);
+    // For when the uniform buffer was written to directly
+    void markUniformsDirty();
 
+    // Uniforms are looked up by the hash of their name, use "name"_hs so it is hashed at compile time
+    // Values are only uploaded on the next use if they changed
     template <typename T>
-    void setUniform(const char* name, T uniform_data);
+    void setUniform(entt::id_type id, T uniform_data);
     template <typename T>
-    void setUniform(const char* name, T* uniform_data);
+    void setUniform(entt::id_type id, T* uniform_data);
 
 private:
-    void setUniformBufferData(size_t offset, GLint uniform_data);
-    void setUniformBufferDataV(size_t offset, size_t count, GLint* uniform_data);
-    void setUniformBufferData(size_t offset, GLfloat uniform_data);
-    void setUniformBufferDataV(size_t offset, size_t count, GLfloat* uniform_data);
-    void setUniformBufferData(size_t offset, glm::vec2 uniform_data);
-    void setUniformBufferDataV(size_t offset, size_t count, glm::vec2* uniform_data);
-    void setUniformBufferData(size_t offset, glm::vec3 uniform_data);
-    void setUniformBufferDataV(size_t offset, size_t count, glm::vec3* uniform_data);
-    void setUniformBufferData(size_t offset, glm::vec4 uniform_data);
-    void setUniformBufferDataV(size_t offset, size_t count, glm::vec4* uniform_data);
-    void setUniformBufferData(size_t offset, glm::mat4 uniform_data);
-    void setUniformBufferDataV(size_t offset, size_t count, glm::mat4* uniform_data);
-    void setUniformBufferData(size_t offset, GLuint uniform_data);
+    void setUniformBufferData(Uniform& uniform, const void* uniform_data, size_t num_bytes);
 
     void initUniformBuffer();
     void getUniforms();
 
-    GLuint id;
+    GLuint id{0};
 public:
     std::vector<Uniform> uniforms;
 private:
@@ -66,23 +76,21 @@ private:
 };
 
 template<typename T>
-void ShaderProgram::setUniform(const char* name, T uniform_data) {
-    for (auto uniform : this->uniforms) {
-        if (!strcmp(uniform.name.c_str(), name)) {
-            this->setUniformBufferData(uniform.buffer_offset, uniform_data);
+void ShaderProgram::setUniform(entt::id_type id, T uniform_data) {
+    static_assert(is_uniform_type_v<T>, "Unsupported uniform type");
+    for (auto& uniform : this->uniforms) {
+        if (uniform.id == id) {
+            this->setUniformBufferData(uniform, &uniform_data, sizeof(T));
         }
     }
 }
 
 template<typename T>
-void ShaderProgram::setUniform(const char* name, T* uniform_data) {
-    for (auto uniform : this->uniforms) {
-        if (!strcmp(uniform.name.c_str(), name)) {
-            this->setUniformBufferDataV(
-                uniform.buffer_offset, 
-                uniform.array_size, 
-                uniform_data
-            );
+void ShaderProgram::setUniform(entt::id_type id, T* uniform_data) {
+    static_assert(is_uniform_type_v<T>, "Unsupported uniform type");
+    for (auto& uniform : this->uniforms) {
+        if (uniform.id == id) {
+            this->setUniformBufferData(uniform, uniform_data, sizeof(T)*uniform.array_size);
         }
     }
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 
 #include <GL\glew.h>
 
+#include <entt/core/hashed_string.hpp>
+
 enum class UniformDataType {
 	INT,
 	INT_ARRAY,
@@ -17,7 +19,8 @@ enum class UniformDataType {
 	VEC_4_ARRAY,
 	MAT_4X4,
 	MAT_4X4_ARRAY,
-	TEX_2D
+	TEX_2D,
+	TEX_2D_ARRAY
 };
 
 inline UniformDataType convertGLType(GLuint type, bool is_array) {
@@ -43,6 +46,9 @@ inline UniformDataType convertGLType(GLuint type, bool is_array) {
         case GL_SAMPLER_2D:
             return UniformDataType::TEX_2D;
             break;
+        case GL_SAMPLER_2D_ARRAY:
+            return UniformDataType::TEX_2D_ARRAY;
+            break;
     }
     assert(!"Unsupported shader uniform type");
     return UniformDataType::INT;
@@ -69,6 +75,7 @@ const UniformData UNIFORM_TYPE_INFO[] = {
     UniformData(64, 16, false, "mat4"),
     UniformData(64, 16, true, "mat4"),
     UniformData(4, 4, false, "sampler2D"),
+    UniformData(4, 4, false, "sampler2DArray"),
 };
 
 struct Uniform {
@@ -77,4 +84,8 @@ struct Uniform {
     size_t array_size;
     GLuint location;
     size_t buffer_offset;
+    // Hash of the name, uniforms are set by it rather than comparing names
+    entt::id_type id{0};
+    // Set when the value in the uniform buffer changed since it was last uploaded
+    bool is_dirty{true};
 };
\ No newline at end of file
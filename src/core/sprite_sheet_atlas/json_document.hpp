@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdlib>
+
+#include <rapidjson/document.h>
+
+#include "asset_load_stats.hpp"
+
+// Heap allocator for the JSON pool and parse stack, counted against the asset being loaded
+class CountingJsonAllocator {
+public:
+    static const bool kNeedFree = true;
+
+    void* Malloc(size_t size) {
+        return (size > 0) ? AssetLoadStats::countedMalloc(size) : nullptr;
+    }
+    void* Realloc(void* original_pointer, size_t original_size, size_t new_size) {
+        (void)original_size;
+        if (new_size == 0) {
+            std::free(original_pointer);
+            return nullptr;
+        }
+        return AssetLoadStats::countedRealloc(original_pointer, new_size);
+    }
+    static void Free(void* pointer) {
+        std::free(pointer);
+    }
+
+    bool operator==(const CountingJsonAllocator&) const {
+        return true;
+    }
+    bool operator!=(const CountingJsonAllocator&) const {
+        return false;
+    }
+};
+
+// The pool is given a reused buffer, so only documents which outgrow it allocate
+using JsonAllocator = rapidjson::MemoryPoolAllocator<CountingJsonAllocator>;
+using JsonDocument = rapidjson::GenericDocument<rapidjson::UTF8<>, JsonAllocator, CountingJsonAllocator>;
+using JsonValue = JsonDocument::ValueType;
\ No newline at end of file
@@ -1,5 +1,9 @@
 #include "sprite_sheet_atlas.hpp"
 
+// stb_image allocations are counted against the asset being loaded
+#define STBI_MALLOC(size) AssetLoadStats::countedMalloc(size)
+#define STBI_REALLOC(pointer, size) AssetLoadStats::countedRealloc(pointer, size)
+#define STBI_FREE(pointer) std::free(pointer)
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
@@ -10,26 +14,240 @@ void SpriteSheetAtlas::initMissingTextureSpriteSheet(
         this->initSpriteSheet(registry, missing_texture_sprite_sheet_id);
 }
 
-SpriteSheet& SpriteSheetAtlas::initSpriteSheet(entt::registry& registry, const std::string& resource_id) {
+SpriteSheet& SpriteSheetAtlas::initSpriteSheet(entt::registry& registry, const std::string& resource_id, TextureCategory category) {
     if (this->sprite_sheets.contains(resource_id)) {
         return this->sprite_sheets[resource_id];
     }
 
-    std::string json_path{
-        globals::RESOURCE_FOLDER + resource_id + "/" + 
-        this->parseSpriteSheetName(resource_id) + ".json"
-    };
-    auto document = this->readJSON(json_path);
+    const std::string json_path{this->getSourcePath(resource_id, ".json")};
+    // The allocator is declared first so it outlives the document built in it
+    JsonAllocator json_allocator(this->json_pool.data(), this->json_pool.size());
+    JsonDocument document(&json_allocator);
 
-    if (document) {
-        this->initAnimations(resource_id, *document);
-        this->initFrames(registry, resource_id, *document);
+    if (this->readJSON(json_path, document)) {
+        this->initAnimations(resource_id, document);
+        this->initFrames(registry, resource_id, document, category);
         return this->sprite_sheets[resource_id];
     } else {
         return this->sprite_sheets[this->missing_texture_sprite_sheet_id];
     }
 }
 
+bool SpriteSheetAtlas::loadBundle(entt::registry& registry, const std::string& bundle_path) {
+    MappedFile bundle;
+    if (!bundle.open(bundle_path)) {
+        return false;
+    }
+    AssetLoadTimer load_timer(bundle_path, bundle.size());
+    BundleReader reader(bundle.data(), bundle.size());
+
+    BundleHeader header;
+    if (!reader.read(header) || 
+        std::memcmp(header.magic, BundleHeader::MAGIC, sizeof(header.magic)) != 0 || 
+        header.version != BundleHeader::VERSION
+    ) {
+        #ifndef NDEBUG
+            std::cerr << "ERROR: " << bundle_path << " is not a sprite sheet bundle of version " << BundleHeader::VERSION << "\n";
+        #endif
+        return false;
+    }
+    // The pages go straight into the atlas texture, so they have to be a size the atlas could have packed
+    if (header.page_width <= 0 || header.page_width > TextureAtlas::MAX_SIDE || 
+        header.page_height <= 0 || header.page_height > TextureAtlas::MAX_SIDE || 
+        header.num_pages <= 0 || header.num_pages > AtlasData::MAX_LAYERS
+    ) {
+        #ifndef NDEBUG
+            std::cerr << "ERROR: Sprite sheet bundle " << bundle_path << " is truncated or corrupt\n";
+        #endif
+        return false;
+    }
+    const unsigned char* pixels = reader.readBytes(static_cast<size_t>(header.page_width)*header.page_height*4*header.num_pages);
+    const unsigned char* texture_bytes = reader.readBytes(static_cast<size_t>(header.num_textures)*sizeof(BundleTexture));
+
+    // Everything is read before any of it is added, so a truncated bundle leaves the atlas untouched
+    struct CookedAnimation {
+        std::string key;
+        AnimationData animation;
+        std::vector<uint32_t> texture_indices;
+    };
+    struct CookedSpriteSheet {
+        SpriteSheet sprite_sheet;
+        BundleSourceFile json_source;
+        BundleSourceFile png_source;
+        std::vector<CookedAnimation> animations;
+    };
+    std::vector<CookedSpriteSheet> cooked_sprite_sheets;
+    bool is_valid = pixels != nullptr && texture_bytes != nullptr;
+
+    // The textures are packed into the pages again, so each one has to lie within a page
+    for (uint32_t it{0}; is_valid && it < header.num_textures; it++) {
+        BundleTexture texture;
+        std::memcpy(&texture, texture_bytes + it*sizeof(BundleTexture), sizeof(BundleTexture));
+        is_valid = texture.layer >= 0 && texture.layer < header.num_pages && 
+            texture.position[0] >= 0 && texture.size[0] >= 0 && texture.position[0] <= header.page_width - texture.size[0] && 
+            texture.position[1] >= 0 && texture.size[1] >= 0 && texture.position[1] <= header.page_height - texture.size[1];
+    }
+
+    for (uint32_t sheet_num{0}; is_valid && sheet_num < header.num_sprite_sheets; sheet_num++) {
+        auto& cooked_sprite_sheet = cooked_sprite_sheets.emplace_back();
+        auto& sprite_sheet = cooked_sprite_sheet.sprite_sheet;
+        uint32_t num_animations{0};
+        is_valid = reader.readString(sprite_sheet.id) && 
+            reader.read(cooked_sprite_sheet.json_source) && 
+            reader.read(cooked_sprite_sheet.png_source) && 
+            reader.read(sprite_sheet.size) && 
+            reader.read(sprite_sheet.sprite_size) && 
+            reader.read(num_animations);
+
+        for (uint32_t animation_num{0}; is_valid && animation_num < num_animations; animation_num++) {
+            auto& [key, animation, texture_indices] = cooked_sprite_sheet.animations.emplace_back();
+            uint32_t num_frames{0};
+            is_valid = reader.readString(key) && reader.readString(animation.name) && reader.read(num_frames);
+            const unsigned char* durations = is_valid ? reader.readBytes(num_frames*sizeof(float)) : nullptr;
+            const unsigned char* indices = durations ? reader.readBytes(num_frames*sizeof(uint32_t)) : nullptr;
+            if (indices == nullptr) {
+                is_valid = false;
+                break;
+            }
+            animation.num_frames = static_cast<int>(num_frames);
+            animation.frame_durations.resize(num_frames);
+            std::memcpy(animation.frame_durations.data(), durations, num_frames*sizeof(float));
+            texture_indices.resize(num_frames);
+            std::memcpy(texture_indices.data(), indices, num_frames*sizeof(uint32_t));
+            is_valid = std::all_of(texture_indices.begin(), texture_indices.end(), [&header](uint32_t texture_index) {
+                return texture_index < header.num_textures;
+            });
+        }
+    }
+    if (!is_valid) {
+        #ifndef NDEBUG
+            std::cerr << "ERROR: Sprite sheet bundle " << bundle_path << " is truncated or corrupt\n";
+        #endif
+        return false;
+    }
+
+    auto& texture_atlas = registry.ctx().at<TextureAtlas&>();
+    std::vector<AtlasData*> textures(header.num_textures);
+    for (uint32_t it{0}; it < header.num_textures; it++) {
+        BundleTexture texture;
+        std::memcpy(&texture, texture_bytes + it*sizeof(BundleTexture), sizeof(BundleTexture));
+        AtlasData atlas_data{
+            glm::ivec2(texture.position[0], texture.position[1]),
+            glm::ivec2(texture.size[0], texture.size[1]),
+            glm::ivec2(texture.offset[0], texture.offset[1]),
+            texture.layer
+        };
+        const auto category = texture.category < static_cast<uint32_t>(TextureCategory::NUM_CATEGORIES) ? 
+            static_cast<TextureCategory>(texture.category) : TextureCategory::SPRITE;
+        textures[it] = texture_atlas.insertCookedTexture(atlas_data, category);
+    }
+    texture_atlas.loadCookedPages(header.page_width, header.page_height, header.num_pages, pixels);
+
+    // Stale sprite sheets are left out so they get initialized from their sources again,
+    // their textures stay in the cooked pages until the bundle is cooked again
+    size_t num_loaded{0};
+    for (auto& [sprite_sheet, json_source, png_source, animations] : cooked_sprite_sheets) {
+        if (json_source.isStale(this->getSourcePath(sprite_sheet.id, ".json")) || 
+            png_source.isStale(this->getSourcePath(sprite_sheet.id, ".png"))
+        ) {
+            #ifndef NDEBUG
+                std::cerr << "WARNING: Sprite sheet " << sprite_sheet.id << " changed since " << bundle_path << " was cooked\n";
+            #endif
+            continue;
+        }
+        for (auto& [key, animation, texture_indices] : animations) {
+            animation.frames.resize(texture_indices.size());
+            for (size_t frame_num{0}; frame_num < texture_indices.size(); frame_num++) {
+                animation.frames[frame_num] = textures[texture_indices[frame_num]];
+            }
+            sprite_sheet.animations[key] = std::move(animation);
+        }
+        const std::string id = sprite_sheet.id;
+        this->sprite_sheets.try_emplace(id, std::move(sprite_sheet));
+        num_loaded++;
+    }
+
+    #ifndef NDEBUG
+        std::cout << "Loaded " << num_loaded << " of " << cooked_sprite_sheets.size() << " sprite sheets from " << bundle_path << "\n";
+    #endif
+    return true;
+}
+
+bool SpriteSheetAtlas::cookBundle(entt::registry& registry, const std::string& bundle_path) {
+    auto& texture_atlas = registry.ctx().at<TextureAtlas&>();
+
+    std::vector<unsigned char> pixels;
+    if (!texture_atlas.copyPages(pixels)) {
+        std::cerr << "ERROR: The atlas released its sources before they could be cooked\n";
+        return false;
+    }
+
+    std::unordered_map<const AtlasData*, uint32_t> texture_indices;
+    for (size_t it{0}; it < texture_atlas.getNumTextures(); it++) {
+        texture_indices[&texture_atlas.getTexture(it)] = static_cast<uint32_t>(it);
+    }
+
+    BundleWriter writer(bundle_path);
+    BundleHeader header{
+        {},
+        BundleHeader::VERSION,
+        texture_atlas.width,
+        texture_atlas.height,
+        texture_atlas.num_pages,
+        static_cast<uint32_t>(texture_atlas.getNumTextures()),
+        static_cast<uint32_t>(this->sprite_sheets.size())
+    };
+    std::memcpy(header.magic, BundleHeader::MAGIC, sizeof(header.magic));
+    writer.write(header);
+    writer.writeBytes(pixels.data(), pixels.size());
+
+    for (size_t it{0}; it < texture_atlas.getNumTextures(); it++) {
+        const AtlasData& atlas_data = texture_atlas.getTexture(it);
+        writer.write(BundleTexture{
+            {atlas_data.position.x, atlas_data.position.y},
+            {atlas_data.size.x, atlas_data.size.y},
+            {atlas_data.offset.x, atlas_data.offset.y},
+            atlas_data.layer,
+            static_cast<uint32_t>(texture_atlas.getTextureCategory(it))
+        });
+    }
+
+    for (const auto& [id, sprite_sheet] : this->sprite_sheets) {
+        writer.writeString(id);
+        writer.write(BundleSourceFile::fromPath(this->getSourcePath(id, ".json")));
+        writer.write(BundleSourceFile::fromPath(this->getSourcePath(id, ".png")));
+        writer.write(sprite_sheet.size);
+        writer.write(sprite_sheet.sprite_size);
+        writer.write(static_cast<uint32_t>(sprite_sheet.animations.size()));
+
+        for (const auto& [key, animation] : sprite_sheet.animations) {
+            writer.writeString(key);
+            writer.writeString(animation.name);
+            writer.write(static_cast<uint32_t>(animation.frames.size()));
+            std::vector<float> durations(animation.frame_durations);
+            durations.resize(animation.frames.size());
+            writer.writeBytes(durations.data(), durations.size()*sizeof(float));
+            for (const AtlasData* frame : animation.frames) {
+                // Every frame has to point into the atlas, otherwise the bundle could not be loaded
+                const auto index_it = texture_indices.find(frame);
+                if (index_it == texture_indices.end()) {
+                    std::cerr << "ERROR: Animation " << key << " of " << id << " has a frame outside of the atlas\n";
+                    return false;
+                }
+                writer.write(index_it->second);
+            }
+        }
+    }
+
+    if (!writer.isGood()) {
+        std::cerr << "ERROR: Unable to write " << bundle_path << "\n";
+        return false;
+    }
+    std::cout << "Cooked " << this->sprite_sheets.size() << " sprite sheets and " << texture_atlas.getNumTextures() << 
+        " textures into " << texture_atlas.num_pages << " pages of " << texture_atlas.width << "x" << texture_atlas.height << "\n";
+    return true;
+}
+
 SpriteSheet& SpriteSheetAtlas::getSpriteSheet(const std::string& sprite_sheet_id) {
     return this->sprite_sheets[sprite_sheet_id];
 }
@@ -38,13 +256,13 @@ SpriteSheet& SpriteSheetAtlas::getMissingTextureSpriteSheet() {
     return this->sprite_sheets[missing_texture_sprite_sheet_id];
 }
 
-void SpriteSheetAtlas::initAnimations(const std::string& sprite_sheet_id, rapidjson::Document& document) {
-    const rapidjson::Value& json_meta{document["meta"]};
-    const rapidjson::Value& json_frames{document["frames"]};
+void SpriteSheetAtlas::initAnimations(const std::string& sprite_sheet_id, JsonDocument& document) {
+    const JsonValue& json_meta{document["meta"]};
+    const JsonValue& json_frames{document["frames"]};
     assert(json_frames.IsArray() && "'frames' value is not array.");
-    const rapidjson::Value& animations{json_meta["frameTags"]};
+    const JsonValue& animations{json_meta["frameTags"]};
     assert(animations.IsArray() && "'animations' value is not array.");
-    const rapidjson::Value& states{json_meta["layers"]};
+    const JsonValue& states{json_meta["layers"]};
     assert(states.IsArray() && "'states' value is not array.");
 
     // Get the sprite_sheet to fill
@@ -67,7 +285,7 @@ void SpriteSheetAtlas::initAnimations(const std::string& sprite_sheet_id, rapidj
         int num_animation_frames{(int)json_frames.Size()};
 
         for (rapidjson::SizeType state_num{0}; state_num < states.Size(); state_num++) {
-            const rapidjson::Value& state{states[state_num]};
+            const JsonValue& state{states[state_num]};
 
             new_sprite_sheet.animations[state["name"].GetString()] = {
                 "default",
@@ -78,12 +296,12 @@ void SpriteSheetAtlas::initAnimations(const std::string& sprite_sheet_id, rapidj
         }
     } else {
         for (rapidjson::SizeType animation_num{0}; animation_num < animations.Size(); animation_num++) {
-            const rapidjson::Value& current_animation{animations[animation_num]};
+            const JsonValue& current_animation{animations[animation_num]};
             
             int num_animation_frames{current_animation["to"].GetInt() - current_animation["from"].GetInt() + 1};
             
             for (rapidjson::SizeType state_num{0}; state_num < states.Size(); state_num++) {
-                const rapidjson::Value& current_state{states[state_num]};
+                const JsonValue& current_state{states[state_num]};
                 std::string animation_name{std::string{current_animation["name"].GetString()} + "_" + std::string{current_state["name"].GetString()}};
 
                 new_sprite_sheet.animations[animation_name] = {
@@ -97,33 +315,42 @@ void SpriteSheetAtlas::initAnimations(const std::string& sprite_sheet_id, rapidj
     }
 }
 
-void SpriteSheetAtlas::initFrames(entt::registry& registry, const std::string& resource_id, rapidjson::Document& document) {
+void SpriteSheetAtlas::initFrames(entt::registry& registry, const std::string& resource_id, JsonDocument& document, TextureCategory category) {
     auto& texture_atlas = registry.ctx().at<TextureAtlas&>();
     
-    const rapidjson::Value& json_meta{document["meta"]};
-    const rapidjson::Value& json_frames{document["frames"]};
+    const JsonValue& json_meta{document["meta"]};
+    const JsonValue& json_frames{document["frames"]};
     assert(json_frames.IsArray() && "'frames' value is not array.");
-    const rapidjson::Value& animations{json_meta["frameTags"]};
+    const JsonValue& animations{json_meta["frameTags"]};
     assert(animations.IsArray() && "'animations' value is not array.");
-    const rapidjson::Value& states{json_meta["layers"]};
+    const JsonValue& states{json_meta["layers"]};
     assert(states.IsArray() && "'states' value is not array.");
 
-    std::string png_path{
-        globals::RESOURCE_FOLDER + resource_id + "/" + 
-        this->parseSpriteSheetName(resource_id) + ".png"
-    };
+    const std::string png_path{this->getSourcePath(resource_id, ".png")};
     SpriteSheet& new_sprite_sheet = this->sprite_sheets[resource_id];
     
     // Loading the sprite_sheet_data
     glm::ivec2 data_size;
     int num_color_channels;
-    unsigned char* texture_data = stbi_load(png_path.c_str(), &(data_size.x), &(data_size.y), &(num_color_channels), STBI_rgb_alpha);
+    unsigned char* texture_data{NULL};
+    MappedFile png_file(png_path);
+    if (png_file.isOpen()) {
+        AssetLoadTimer load_timer(png_path, png_file.size());
+        texture_data = stbi_load_from_memory(
+            png_file.data(), 
+            static_cast<int>(png_file.size()), 
+            &(data_size.x), 
+            &(data_size.y), 
+            &(num_color_channels), 
+            STBI_rgb_alpha
+        );
+    }
     // If two frames use the same pixel data, then it needs to not be added to the texture atlas a second time
     std::unordered_map<std::string, AtlasData*> frame_map;
 
     // Fill animations with newly-initialized AtlasData
     for (rapidjson::SizeType frame_num{0}; frame_num < json_frames.Size(); frame_num++) {
-        const rapidjson::Value& frame = json_frames[frame_num];
+        const JsonValue& frame = json_frames[frame_num];
 
         // Filename is a string that looks like "{sprite_sheet_name}_{animation_name}_{direction}_{frame_number}"
         std::string sprite_frame_name = frame["filename"].GetString();
@@ -140,35 +367,32 @@ void SpriteSheetAtlas::initFrames(entt::registry& registry, const std::string& r
         std::string key{this->getTextureSourceKey(new_texture)};
 
         if (!frame_map.contains(key)) {
-            frame_map[key] = texture_atlas.insertTexture(new_texture);
+            frame_map[key] = texture_atlas.insertTexture(new_texture, category);
         }
         curr_animation_data.frames[animation_frame_num] = frame_map[key];
     }
     stbi_image_free(texture_data);
 }
 
-std::optional<rapidjson::Document> SpriteSheetAtlas::readJSON(const std::string& json_path) {
-    std::string json;
-	std::ifstream json_stream(json_path, std::ios::in);
-
-    std::optional<rapidjson::Document> document;
-
-	if(json_stream.is_open()){
-		std::stringstream sstr;
-		sstr << json_stream.rdbuf();
-		json = sstr.str();
-		json_stream.close();
-
-        document = rapidjson::Document();
-        document->Parse(json.c_str());
-
-	} else {
+bool SpriteSheetAtlas::readJSON(const std::string& json_path, JsonDocument& document) {
+    MappedFile json_file(json_path);
+    if (!json_file.isOpen()) {
         #ifndef NDEBUG
-		    std::cerr << "Unable to open " << json_path << std::endl;
+            std::cerr << "Unable to open " << json_path << std::endl;
         #endif
-	}
+        return false;
+    }
 
-    return document;
+    AssetLoadTimer load_timer(json_path, json_file.size());
+    // The mapping is read only and has no terminating null, so it is parsed with its length instead of in situ
+    document.Parse(reinterpret_cast<const char*>(json_file.data()), json_file.size());
+    if (document.HasParseError()) {
+        #ifndef NDEBUG
+            std::cerr << "Unable to parse " << json_path << " at offset " << document.GetErrorOffset() << std::endl;
+        #endif
+        return false;
+    }
+    return true;
 }
 
 // Parses frame name as tuple of animation name, direction, frame number
@@ -204,13 +428,17 @@ std::string SpriteSheetAtlas::parseSpriteSheetName(const std::string& resource_i
     return resource_id.substr(resource_id.find_last_of('/') + 1);
 }
 
-TextureSource SpriteSheetAtlas::textureSourceFromFrame(const rapidjson::Value& frame, unsigned char* texture_data, glm::ivec2 texture_data_size) {
+std::string SpriteSheetAtlas::getSourcePath(const std::string& resource_id, const std::string& extension) {
+    return globals::RESOURCE_FOLDER + resource_id + "/" + this->parseSpriteSheetName(resource_id) + extension;
+}
+
+TextureSource SpriteSheetAtlas::textureSourceFromFrame(const JsonValue& frame, unsigned char* texture_data, glm::ivec2 texture_data_size) {
     // Get sprite data
-    const rapidjson::Value& sprite_info{frame["spriteSourceSize"]};
+    const JsonValue& sprite_info{frame["spriteSourceSize"]};
     glm::ivec2 size(sprite_info["w"].GetInt(), sprite_info["h"].GetInt());
     glm::ivec2 offset(sprite_info["x"].GetInt(), sprite_info["y"].GetInt());
 
-    const rapidjson::Value& frame_pos_in_sprite_sheet{frame["frame"]};
+    const JsonValue& frame_pos_in_sprite_sheet{frame["frame"]};
     glm::ivec2 source_offset(frame_pos_in_sprite_sheet["x"].GetInt(), 
         frame_pos_in_sprite_sheet["y"].GetInt());
 
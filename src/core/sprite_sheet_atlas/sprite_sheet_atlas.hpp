@@ -6,6 +6,8 @@
 #include <cctype>
 #include <algorithm>
 #include <tuple>
+#include <limits>
+#include <cstring>
 
 #include <entt/entt.hpp>
 #include <glm/glm.hpp>
@@ -13,6 +15,10 @@
 #include "globals.hpp"
 #include "animation_structs.hpp"
 #include "texture_atlas.hpp"
+#include "mapped_file.hpp"
+#include "asset_load_stats.hpp"
+#include "json_document.hpp"
+#include "sprite_sheet_bundle.hpp"
 
 class SpriteSheetAtlas {
 public:
@@ -20,23 +26,41 @@ public:
         entt::registry& registry, 
         std::string missing_texture_sprite_sheet_id
     );
-    SpriteSheet& initSpriteSheet(entt::registry& registry, const std::string& sprite_sheet_id);
+    // The category is only used to report the atlas memory held for the sprite sheet's frames
+    SpriteSheet& initSpriteSheet(
+        entt::registry& registry, 
+        const std::string& sprite_sheet_id, 
+        TextureCategory category = TextureCategory::SPRITE
+    );
     SpriteSheet& getSpriteSheet(const std::string& sprite_sheet_id);
     SpriteSheet& getMissingTextureSpriteSheet();
+
+    // Adds every sprite sheet in a bundle written by cookBundle, along with the atlas pages they were packed into
+    // Must be loaded before any other texture is inserted into the atlas, returns false if there is no usable bundle
+    bool loadBundle(entt::registry& registry, const std::string& bundle_path);
+    // Writes every sprite sheet initialized so far, the atlas needs to have been updated while keeping its sources
+    bool cookBundle(entt::registry& registry, const std::string& bundle_path);
     
 private:
-    void initAnimations(const std::string& sprite_sheet_id, rapidjson::Document& document);
-    void initFrames(entt::registry& registry, const std::string& sprite_sheet_id, rapidjson::Document& document);
+    void initAnimations(const std::string& sprite_sheet_id, JsonDocument& document);
+    void initFrames(entt::registry& registry, const std::string& sprite_sheet_id, JsonDocument& document, TextureCategory category);
 
     std::tuple<std::string, int> parseFrameName(const std::string& frame_name);
     std::string parseSpriteSheetName(const std::string& sprite_sheet_id);
-    TextureSource textureSourceFromFrame(const rapidjson::Value& frame, unsigned char* texture_data, glm::ivec2 texture_data_size);
+    // The path of the sprite sheet's file with the extension, either ".json" or ".png"
+    std::string getSourcePath(const std::string& sprite_sheet_id, const std::string& extension);
+    TextureSource textureSourceFromFrame(const JsonValue& frame, unsigned char* texture_data, glm::ivec2 texture_data_size);
 
-    std::optional<rapidjson::Document> readJSON(const std::string& json_path);
+    // Parses the mapped file with the document's allocator, returns false if it could not be read or parsed
+    bool readJSON(const std::string& json_path, JsonDocument& document);
 
     std::string getTextureSourceKey(const TextureSource& texture_source);
 
     std::unordered_map<std::string, SpriteSheet> sprite_sheets;
 
     std::string missing_texture_sprite_sheet_id;
+
+    // Every sprite sheet's JSON is parsed into this buffer, which is reused once the sprite sheet is initialized
+    static constexpr size_t JSON_POOL_SIZE{256*1024};
+    std::vector<unsigned char> json_pool = std::vector<unsigned char>(JSON_POOL_SIZE);
 };
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+
+// A sprite sheet bundle is written by --cook-assets and holds every sprite sheet already packed into the atlas:
+//  BundleHeader
+//  The atlas pages, width*height*4 bytes each
+//  BundleTexture for every texture, in the order they were inserted into the atlas
+//  Every sprite sheet: id, its JSON and PNG as BundleSourceFile, size, sprite size, number of animations, then for each animation
+//      its key, name, number of frames, frame durations and the index of the texture of each frame
+// Strings are stored as their length followed by their characters
+// Values are copied as they are in memory, so the bundle is in the byte order of the machine that cooked it
+//  and is only meant to be loaded on the same platform
+// Every frame's texture index must be below the number of textures, anything else is a corrupt bundle
+struct BundleHeader {
+    static constexpr char MAGIC[4]{'N', 'E', 'S', 'B'};
+    static constexpr uint32_t VERSION{2};
+
+    char magic[4];
+    uint32_t version;
+    int32_t page_width;
+    int32_t page_height;
+    int32_t num_pages;
+    uint32_t num_textures;
+    uint32_t num_sprite_sheets;
+};
+
+struct BundleTexture {
+    int32_t position[2];
+    int32_t size[2];
+    int32_t offset[2];
+    int32_t layer;
+    uint32_t category;
+};
+
+// The size and last write time of a file a sprite sheet was cooked from, a sprite sheet is stale once
+// a source file that still exists no longer matches. Sources which are gone keep their cooked sprite sheet,
+// so a bundle can be shipped without them
+struct BundleSourceFile {
+    uint64_t size;
+    int64_t write_time;
+
+    static BundleSourceFile fromPath(const std::string& path) {
+        std::error_code size_error;
+        std::error_code time_error;
+        const auto size = std::filesystem::file_size(path, size_error);
+        const auto write_time = std::filesystem::last_write_time(path, time_error);
+        if (size_error || time_error) {
+            return BundleSourceFile{0, 0};
+        }
+        return BundleSourceFile{
+            static_cast<uint64_t>(size), 
+            static_cast<int64_t>(write_time.time_since_epoch().count())
+        };
+    }
+    bool isStale(const std::string& path) const {
+        std::error_code exists_error;
+        if (!std::filesystem::exists(path, exists_error)) {
+            return false;
+        }
+        const BundleSourceFile current = BundleSourceFile::fromPath(path);
+        return current.size != this->size || current.write_time != this->write_time;
+    }
+};
+
+class BundleWriter {
+public:
+    BundleWriter(const std::string& path) : stream{path, std::ios::out | std::ios::binary} {}
+
+    template<typename T>
+    void write(const T& value) {
+        this->stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    void writeBytes(const void* data, size_t num_bytes) {
+        this->stream.write(static_cast<const char*>(data), num_bytes);
+    }
+    void writeString(const std::string& value) {
+        this->write(static_cast<uint32_t>(value.size()));
+        this->writeBytes(value.data(), value.size());
+    }
+    bool isGood() const {
+        return this->stream.good();
+    }
+
+private:
+    std::ofstream stream;
+};
+
+// Reads values out of a mapped bundle, every read fails once the end of the data has been passed
+class BundleReader {
+public:
+    BundleReader(const unsigned char* data, size_t size) : data{data}, size{size} {}
+
+    template<typename T>
+    bool read(T& value) {
+        const unsigned char* bytes = this->readBytes(sizeof(T));
+        if (bytes == nullptr) {
+            return false;
+        }
+        std::memcpy(&value, bytes, sizeof(T));
+        return true;
+    }
+    const unsigned char* readBytes(size_t num_bytes) {
+        if (num_bytes > this->size - this->offset) {
+            this->offset = this->size;
+            return nullptr;
+        }
+        const unsigned char* bytes = this->data + this->offset;
+        this->offset += num_bytes;
+        return bytes;
+    }
+    bool readString(std::string& value) {
+        uint32_t length;
+        if (!this->read(length)) {
+            return false;
+        }
+        const unsigned char* bytes = this->readBytes(length);
+        if (bytes == nullptr) {
+            return false;
+        }
+        value.assign(reinterpret_cast<const char*>(bytes), length);
+        return true;
+    }
+
+private:
+    const unsigned char* data;
+    size_t size;
+    size_t offset{0};
+};
\ No newline at end of file
@@ -4,7 +4,24 @@
 
 // Data about the frame's location in the texture atlas texture
 struct AtlasData {
+    // Instances only carry 16 bits for the x position, the layer is packed above the position
+    //  so the layer adds multiples of this, the shaders split them apart again
+    static constexpr int LAYER_STRIDE{4096};
+    static constexpr int MAX_LAYERS{65536/LAYER_STRIDE};
+
     glm::ivec2 position;
     glm::ivec2 size; // Width, height
     glm::ivec2 offset;
-};
\ No newline at end of file
+    // The page of the atlas the frame is on
+    int layer{0};
+};
+
+// x with the layer packed in, y, width, height, as read by the instanced shaders
+inline glm::vec4 getTextureData(const AtlasData& atlas_data, glm::ivec2 offset = glm::ivec2(0, 0)) {
+    return glm::vec4(
+        atlas_data.position.x + offset.x + atlas_data.layer*AtlasData::LAYER_STRIDE, 
+        atlas_data.position.y + offset.y, 
+        atlas_data.size.x, 
+        atlas_data.size.y
+    );
+}
\ No newline at end of file
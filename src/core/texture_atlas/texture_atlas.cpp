@@ -1,10 +1,13 @@
 #include "texture_atlas.hpp"
 
 TextureAtlas::TextureAtlas() {
+    if (Headless::isEnabled()) {
+        return;
+    }
     glGenTextures(1, &(this->gl_texture_id));
 }
 
-AtlasData* TextureAtlas::insertTexture(const TextureSource& source) {
+AtlasData* TextureAtlas::insertTexture(const TextureSource& source, TextureCategory category) {
     // Format is always converted to RGBA
     int format_size{0};
     const int dest_format_size{4};
@@ -57,95 +60,378 @@ AtlasData* TextureAtlas::insertTexture(const TextureSource& source) {
     };
 
     auto& new_atlas_data = this->atlas_data.emplace_back(glm::vec2(), source.size, source.offset);
-    this->sources_data.emplace_back(this->sources.size(), &new_atlas_data);
-    sources.emplace_back(new_source_data);
+    this->sources_data.push_back({static_cast<int>(this->sources.size()), &new_atlas_data, category});
+    this->sources.push_back(std::move(new_source_data));
 
     return &new_atlas_data;
 }
 
 void TextureAtlas::updateAtlas() {
-    this->updateAtlasDataPacking();
-    this->updateAtlasTexture();
+    if (this->num_packed_sources == this->sources_data.size()) {
+        return;
+    }
+    if (this->packNewTextures()) {
+        this->uploadTextures(this->num_packed_sources);
+    } else {
+        this->updateAtlasDataPacking();
+        this->updateAtlasTexture();
+    }
+    this->num_packed_sources = this->sources_data.size();
 }
 
-void TextureAtlas::updateAtlasDataPacking() {
-    // Get the packing of the AtlasData rectangles
-    constexpr bool allow_flip = false;
-    const auto runtime_flipping_mode = rectpack2D::flipping_option::DISABLED;
-    using spaces_type = rectpack2D::empty_spaces<allow_flip, rectpack2D::default_empty_spaces>;
-    using rect_type = rectpack2D::output_rect_t<spaces_type>;
+void TextureAtlas::setMemoryMode(AtlasMemoryMode memory_mode) {
+    this->memory_mode = memory_mode;
+    if (memory_mode != AtlasMemoryMode::RELEASE_SOURCES) {
+        return;
+    }
+    for (auto& source_data : this->sources_data) {
+        if (source_data.is_resident) {
+            this->releaseSource(source_data);
+        }
+    }
+}
 
-    auto report_successful = [](rect_type&) {
-		return rectpack2D::callback_result::CONTINUE_PACKING;
-	};
+AtlasMemoryMode TextureAtlas::getMemoryMode() const {
+    return this->memory_mode;
+}
 
-	auto report_unsuccessful = [](rect_type&) {
-        #ifndef NDEBUG
-            std::cerr << "ERROR: Unsuccessful insertion rectpack2D" << "\n";
-        #endif
-		return rectpack2D::callback_result::ABORT_PACKING;
-	};
+AtlasMemoryStats TextureAtlas::getMemoryStats() const {
+    AtlasMemoryStats stats;
+    for (const auto& source_data : this->sources_data) {
+        auto& category_stats = stats.categories[static_cast<size_t>(source_data.category)];
+        category_stats.num_sources++;
+        category_stats.source_bytes += this->sources[source_data.source_index].capacity();
+        if (source_data.is_resident) {
+            category_stats.resident_bytes += source_data.atlas_data->size.x*source_data.atlas_data->size.y*4;
+        }
+    }
+    stats.texture_bytes = static_cast<size_t>(this->width)*this->height*4*this->num_pages;
+    return stats;
+}
 
-    const auto max_side = 2048;
-    const auto discard_step = 1;
+void TextureAtlas::releaseSource(TextureSourceData& source_data) {
+    if (source_data.is_released) {
+        return;
+    }
+    // clear() keeps the allocation, swapping with an empty vector frees it
+    std::vector<unsigned char>().swap(this->sources[source_data.source_index]);
+    source_data.is_released = true;
+    this->num_released_sources++;
+}
 
-    std::vector<rect_type> rectangles;
-    rectangles.reserve(this->atlas_data.size());
+bool TextureAtlas::packNewTextures() {
+    for (size_t it{this->num_packed_sources}; it < this->sources_data.size(); it++) {
+        auto& atlas_loc = *(this->sources_data[it].atlas_data);
+        if (atlas_loc.size.x * atlas_loc.size.y == 0) {
+            atlas_loc.position = glm::ivec2(0, 0);
+            continue;
+        }
+        // New pages can not be added without reallocating the texture, so that is left to a repack
+        if (!this->packTexture(atlas_loc, false)) {
+            return false;
+        }
+    }
+    return true;
+}
 
-    for (auto texture : this->atlas_data) {
-        rectangles.emplace_back(0, 0, texture.size.x, texture.size.y);
+bool TextureAtlas::packTexture(AtlasData& atlas_loc, bool can_add_page) {
+    const rectpack2D::rect_wh rect_size(atlas_loc.size.x, atlas_loc.size.y);
+    for (size_t page{0}; page < this->pages.size(); page++) {
+        if (const auto rect = this->pages[page].insert(rect_size)) {
+            atlas_loc.position = glm::ivec2(rect->x, rect->y);
+            atlas_loc.layer = static_cast<int>(page);
+            return true;
+        }
+    }
+    if (!can_add_page || this->pages.size() >= AtlasData::MAX_LAYERS) {
+        return false;
+    }
+
+    auto& page = this->pages.emplace_back(rectpack2D::rect_wh(this->width, this->height));
+    if (const auto rect = page.insert(rect_size)) {
+        atlas_loc.position = glm::ivec2(rect->x, rect->y);
+        atlas_loc.layer = static_cast<int>(this->pages.size() - 1);
+        return true;
     }
+    // Larger than a whole page
+    this->pages.pop_back();
+    return false;
+}
 
-    const auto result_size = rectpack2D::find_best_packing<spaces_type>(rectangles, rectpack2D::make_finder_input(
-				max_side,
-				discard_step,
-				report_successful,
-				report_unsuccessful,
-				runtime_flipping_mode
-	));
-    
-    this->width = result_size.w;
-    this->height = result_size.h;
+void TextureAtlas::updateAtlasDataPacking() {
+    // The atlas is never shrunk, so the space freed by repacking is left for the next textures
+    constexpr int min_side = 256;
+    constexpr int max_side = TextureAtlas::MAX_SIDE;
+
+    // Larger textures are packed first, which leaves fewer gaps
+    std::vector<AtlasData*> packing_order;
+    packing_order.reserve(this->sources_data.size());
+    for (const auto& source_data : this->sources_data) {
+        if (source_data.atlas_data->size.x * source_data.atlas_data->size.y == 0) {
+            source_data.atlas_data->position = glm::ivec2(0, 0);
+        } else {
+            packing_order.push_back(source_data.atlas_data);
+        }
+    }
+    std::stable_sort(packing_order.begin(), packing_order.end(), [](const AtlasData* lhs, const AtlasData* rhs) {
+        const int lhs_side = std::max(lhs->size.x, lhs->size.y);
+        const int rhs_side = std::max(rhs->size.x, rhs->size.y);
+        if (lhs_side != rhs_side) {
+            return lhs_side > rhs_side;
+        }
+        return lhs->size.x*lhs->size.y > rhs->size.x*rhs->size.y;
+    });
+
+    // Pages are only added once the first page can not grow any further
+    this->width = std::max(this->width, min_side);
+    this->height = std::max(this->height, min_side);
+    while (true) {
+        const bool is_max_size = this->width >= max_side && this->height >= max_side;
+        this->pages.assign(1, PackingSpaces(rectpack2D::rect_wh(this->width, this->height)));
+
+        bool is_packed{true};
+        for (AtlasData* atlas_loc : packing_order) {
+            if (this->packTexture(*atlas_loc, is_max_size)) {
+                continue;
+            }
+            if (!is_max_size) {
+                is_packed = false;
+                break;
+            }
+            #ifndef NDEBUG
+                std::cerr << "ERROR: Unsuccessful insertion rectpack2D" << "\n";
+            #endif
+            atlas_loc->position = glm::ivec2(0, 0);
+            atlas_loc->layer = 0;
+        }
+        if (is_packed) {
+            break;
+        }
+        // Grow the shorter side, keeping the atlas close to square
+        if (this->width <= this->height && this->width < max_side) {
+            this->width *= 2;
+        } else {
+            this->height *= 2;
+        }
+    }
+    this->num_pages = static_cast<int>(this->pages.size());
 
     #ifndef NDEBUG
-        std::cout << "Resulting texture size: " << result_size.w << " " << result_size.h << "\n";
+        std::cout << "Resulting texture size: " << this->width << " " << this->height << " pages: " << this->num_pages << "\n";
     #endif
+}
 
-    // Assign the generated positions to the atlas datas
-    auto rect_it{rectangles.begin()};
-    auto atlas_data_it{this->atlas_data.begin()};
+void TextureAtlas::updateAtlasTexture() {
+    // The released textures are only left in the current texture, so it is kept until they are copied out of it
+    GLuint previous_texture_id{0};
+    if (this->num_released_sources > 0 && !Headless::isEnabled()) {
+        previous_texture_id = this->gl_texture_id;
+        glGenTextures(1, &(this->gl_texture_id));
+    }
+
+    if (Headless::isEnabled()) {
+        // Record the same uploads that would be made with a GL context
+        Headless::recordTextureUpload(this->width*this->height*4*this->num_pages);
+    } else {
+        this->allocateTexture();
 
-    while (atlas_data_it != atlas_data.end()) {
-        atlas_data_it->position = glm::ivec2(rect_it->x, rect_it->y);
-        rect_it++;
-        atlas_data_it++;
+        // One page of zeros is enough to clear every page
+        std::vector<unsigned char> empty_page(this->width*this->height*4);
+        for (int page{0}; page < this->num_pages; page++) {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, page, this->width, this->height, 1, GL_RGBA, GL_UNSIGNED_BYTE, empty_page.data());
+        }
+    }
+
+    this->copyReleasedTextures(previous_texture_id);
+    this->uploadTextures(0);
+
+    if (previous_texture_id != 0) {
+        glDeleteTextures(1, &previous_texture_id);
     }
 }
 
-void TextureAtlas::updateAtlasTexture() {
-    std::vector<unsigned char> empty_texture_source(this->width*this->height*4);
-    
-    glBindTexture(GL_TEXTURE_2D, this->gl_texture_id);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, this->width, this->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, empty_texture_source.data());
+void TextureAtlas::allocateTexture() {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, this->gl_texture_id);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, this->width, this->height, this->num_pages, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    // The atlas is sampled texel by texel, so it has no mipmaps to keep up to date with every upload
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
 
-    for (auto source_data_it{this->sources_data.begin()}; source_data_it != this->sources_data.end(); source_data_it++) {
+void TextureAtlas::uploadTextures(size_t first_source) {
+    if (!Headless::isEnabled()) {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, this->gl_texture_id);
+    }
+
+    for (auto source_data_it{this->sources_data.begin() + first_source}; source_data_it != this->sources_data.end(); source_data_it++) {
         auto& source = sources[source_data_it->source_index];
         auto& atlas_loc = *(source_data_it->atlas_data);
         // Having textures with zero for one or both dimensions is ok, but it should not be attempted to be put in the texture
-        if (atlas_loc.size.x * atlas_loc.size.y != 0) {
-            glTexSubImage2D(
-                GL_TEXTURE_2D, 
+        // Released textures have already been copied into place
+        if (atlas_loc.size.x * atlas_loc.size.y == 0 || source_data_it->is_released) {
+            continue;
+        }
+        source_data_it->is_resident = true;
+        source_data_it->resident_position = atlas_loc.position;
+        source_data_it->resident_layer = atlas_loc.layer;
+
+        if (Headless::isEnabled()) {
+            Headless::recordTextureUpload(atlas_loc.size.x*atlas_loc.size.y*4);
+        } else {
+            glTexSubImage3D(
+                GL_TEXTURE_2D_ARRAY, 
                 0, 
                 atlas_loc.position.x, 
                 atlas_loc.position.y, 
+                atlas_loc.layer, 
                 atlas_loc.size.x, 
                 atlas_loc.size.y,
+                1,
                 GL_RGBA, 
                 GL_UNSIGNED_BYTE,
                 source.data()
             );
         }
-    };
+        if (this->memory_mode == AtlasMemoryMode::RELEASE_SOURCES) {
+            this->releaseSource(*source_data_it);
+        }
+    }
+}
+
+void TextureAtlas::copyReleasedTextures(GLuint previous_texture_id) {
+    if (this->num_released_sources == 0) {
+        return;
+    }
+    if (!Headless::isEnabled()) {
+        if (this->copy_fbo == 0) {
+            glGenFramebuffers(1, &(this->copy_fbo));
+        }
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, this->copy_fbo);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, this->gl_texture_id);
+    }
+
+    // GL 3.3 has no glCopyImageSubData, so each layer of the previous texture is read through a framebuffer
+    int attached_layer{-1};
+    for (auto& source_data : this->sources_data) {
+        if (!source_data.is_released) {
+            continue;
+        }
+        const auto& atlas_loc = *(source_data.atlas_data);
+        if (!Headless::isEnabled()) {
+            if (source_data.resident_layer != attached_layer) {
+                attached_layer = source_data.resident_layer;
+                glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, previous_texture_id, 0, attached_layer);
+            }
+            glCopyTexSubImage3D(
+                GL_TEXTURE_2D_ARRAY, 
+                0, 
+                atlas_loc.position.x, 
+                atlas_loc.position.y, 
+                atlas_loc.layer, 
+                source_data.resident_position.x, 
+                source_data.resident_position.y, 
+                atlas_loc.size.x, 
+                atlas_loc.size.y
+            );
+        }
+        source_data.resident_position = atlas_loc.position;
+        source_data.resident_layer = atlas_loc.layer;
+    }
+
+    if (!Headless::isEnabled()) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    }
+}
+
+AtlasData* TextureAtlas::insertCookedTexture(const AtlasData& atlas_data, TextureCategory category) {
+    auto& new_atlas_data = this->atlas_data.emplace_back(atlas_data);
+    auto& source_data = this->sources_data.emplace_back(TextureSourceData{static_cast<int>(this->sources.size()), &new_atlas_data, category});
+    this->sources.emplace_back();
+
+    // The pixels are only ever in the atlas texture, so they are copied like released textures when repacking
+    if (atlas_data.size.x * atlas_data.size.y != 0) {
+        source_data.is_resident = true;
+        source_data.is_released = true;
+        source_data.resident_position = atlas_data.position;
+        source_data.resident_layer = atlas_data.layer;
+        this->num_released_sources++;
+    }
+    return &new_atlas_data;
+}
+
+void TextureAtlas::loadCookedPages(int width, int height, int num_pages, const unsigned char* pixels) {
+    // The free space around the cooked textures is not stored, packing them again the same way the cooker did
+    //  rebuilds it without touching any pixels
+    std::vector<AtlasData> cooked_locations;
+    cooked_locations.reserve(this->sources_data.size());
+    for (const auto& source_data : this->sources_data) {
+        cooked_locations.push_back(*(source_data.atlas_data));
+    }
+    this->width = width;
+    this->height = height;
+    this->updateAtlasDataPacking();
+
+    bool is_same_packing = this->width == width && this->height == height && this->num_pages == num_pages;
+    for (size_t it{0}; it < this->sources_data.size(); it++) {
+        auto& atlas_loc = *(this->sources_data[it].atlas_data);
+        is_same_packing = is_same_packing && 
+            atlas_loc.position == cooked_locations[it].position && 
+            atlas_loc.layer == cooked_locations[it].layer;
+        atlas_loc = cooked_locations[it];
+    }
+    if (!is_same_packing) {
+        #ifndef NDEBUG
+            std::cerr << "WARNING: Cooked atlas packing could not be reproduced, new textures will repack the atlas\n";
+        #endif
+        // Without the free space nothing fits, so the next update repacks everything
+        this->pages.clear();
+        this->width = width;
+        this->height = height;
+        this->num_pages = num_pages;
+    }
+    this->num_packed_sources = this->sources_data.size();
+
+    if (Headless::isEnabled()) {
+        Headless::recordTextureUpload(this->width*this->height*4*this->num_pages);
+        return;
+    }
+    this->allocateTexture();
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, this->width, this->height, this->num_pages, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+}
+
+bool TextureAtlas::copyPages(std::vector<unsigned char>& pixels) const {
+    const size_t page_bytes = static_cast<size_t>(this->width)*this->height*4;
+    pixels.assign(page_bytes*this->num_pages, 0);
+
+    for (const auto& source_data : this->sources_data) {
+        const auto& atlas_loc = *(source_data.atlas_data);
+        if (atlas_loc.size.x * atlas_loc.size.y == 0) {
+            continue;
+        }
+        if (source_data.is_released) {
+            return false;
+        }
+        const auto& source = this->sources[source_data.source_index];
+        const size_t row_bytes = atlas_loc.size.x*4;
+        for (int y{0}; y < atlas_loc.size.y; y++) {
+            std::copy_n(
+                source.begin() + y*row_bytes, 
+                row_bytes, 
+                pixels.begin() + page_bytes*atlas_loc.layer + ((atlas_loc.position.y + y)*this->width + atlas_loc.position.x)*4
+            );
+        }
+    }
+    return true;
+}
+
+size_t TextureAtlas::getNumTextures() const {
+    return this->sources_data.size();
+}
+
+const AtlasData& TextureAtlas::getTexture(size_t texture_index) const {
+    return *(this->sources_data[texture_index].atlas_data);
+}
 
-    glGenerateMipmap(GL_TEXTURE_2D);
+TextureCategory TextureAtlas::getTextureCategory(size_t texture_index) const {
+    return this->sources_data[texture_index].category;
 }
\ No newline at end of file
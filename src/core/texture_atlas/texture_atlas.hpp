@@ -1,10 +1,13 @@
 #pragma once
 
 #include <list>
+#include <vector>
+#include <algorithm>
 #include <string>
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <cstdint>
 
 #include <entt/entt.hpp>
 #include <glm/glm.hpp>
@@ -17,6 +20,7 @@
 #include "animation.hpp"
 
 #include "atlas_data.hpp"
+#include "headless.hpp"
 
 struct TextureSource {
     unsigned char* data;
@@ -27,27 +31,108 @@ struct TextureSource {
     glm::ivec2 source_offset; // Offset from source data begin
 };
 
+// The kind of asset a texture was inserted for, memory is reported per category
+enum class TextureCategory : uint8_t {
+    SPRITE,
+    TILE,
+    GLYPH,
+    NUM_CATEGORIES
+};
+
+enum class AtlasMemoryMode : uint8_t {
+    // A copy of every texture's pixels is kept so a repack can upload everything again
+    KEEP_SOURCES,
+    // Pixels are freed once uploaded, a repack copies them from the previous texture instead
+    RELEASE_SOURCES
+};
+
+struct AtlasCategoryMemory {
+    size_t num_sources{0};
+    size_t source_bytes{0}; // Held on the CPU
+    size_t resident_bytes{0}; // Uploaded to the atlas texture
+};
+
+struct AtlasMemoryStats {
+    AtlasCategoryMemory categories[static_cast<size_t>(TextureCategory::NUM_CATEGORIES)];
+    size_t texture_bytes{0}; // Size of every page of the atlas texture
+};
+
+// Textures inserted since the last update are packed into the free space left in the atlas
+//  and only their regions are uploaded, the whole atlas is only repacked when they do not fit
+// Once a page reaches the maximum size, further pages are added as layers of a GL_TEXTURE_2D_ARRAY
+//  so every frame can still be drawn from the one texture
 class TextureAtlas {
 
 public:
+    // The largest width and height a page grows to
+    static constexpr int MAX_SIDE{2048};
+    static_assert(MAX_SIDE <= AtlasData::LAYER_STRIDE, "positions must stay below the packed layer");
+
     TextureAtlas();
 
-    AtlasData* insertTexture(const TextureSource& source);
+    AtlasData* insertTexture(const TextureSource& source, TextureCategory category = TextureCategory::SPRITE);
     void updateAtlas();
 
+    // Switching to RELEASE_SOURCES frees the pixels of every texture which is already uploaded
+    void setMemoryMode(AtlasMemoryMode memory_mode);
+    AtlasMemoryMode getMemoryMode() const;
+    AtlasMemoryStats getMemoryStats() const;
+
+    // Textures packed ahead of time by the asset cooker are inserted without pixels,
+    //  all of them must be inserted before any other texture, then their pages are loaded whole
+    AtlasData* insertCookedTexture(const AtlasData& atlas_data, TextureCategory category);
+    void loadCookedPages(int width, int height, int num_pages, const unsigned char* pixels);
+    // Fills every page from the kept sources, returns false if any have been released
+    bool copyPages(std::vector<unsigned char>& pixels) const;
+
+    // Textures in the order they were inserted
+    size_t getNumTextures() const;
+    const AtlasData& getTexture(size_t texture_index) const;
+    TextureCategory getTextureCategory(size_t texture_index) const;
+
     int num_color_channels;
-    GLuint gl_texture_id;
+    GLuint gl_texture_id{0};
+    // Size of every page
     int width{0};
     int height{0};
+    int num_pages{0};
 
 private:
     struct TextureSourceData {
         int source_index;
         AtlasData* atlas_data;
+        TextureCategory category;
+        bool is_resident{false};
+        // Only the copy in the atlas texture is left
+        bool is_released{false};
+        // Where the texture was last uploaded, the atlas_data is moved before a repack copies from here
+        glm::ivec2 resident_position{0, 0};
+        int resident_layer{0};
     };
 
+    using PackingSpaces = rectpack2D::empty_spaces<false, rectpack2D::default_empty_spaces>;
+
+    // Returns false if a new texture did not fit into the free space
+    bool packNewTextures();
+    // Inserts into the first page with space for it
+    bool packTexture(AtlasData& atlas_loc, bool can_add_page);
     void updateAtlasDataPacking();
     void updateAtlasTexture();
+    void allocateTexture();
+    void uploadTextures(size_t first_source);
+    // Copies the released textures from where they were in the previous texture to their new location
+    void copyReleasedTextures(GLuint previous_texture_id);
+    void releaseSource(TextureSourceData& source_data);
+
+    // The free space of each page, kept between updates so new textures can be inserted into it
+    std::vector<PackingSpaces> pages;
+    // Sources before this have been packed and uploaded
+    size_t num_packed_sources{0};
+    size_t num_released_sources{0};
+
+    AtlasMemoryMode memory_mode{AtlasMemoryMode::RELEASE_SOURCES};
+    // Reads from the previous texture while copying released textures
+    GLuint copy_fbo{0};
 
     std::vector<TextureSourceData> sources_data;
     std::vector<std::vector<unsigned char>> sources;
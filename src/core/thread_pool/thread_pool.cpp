@@ -0,0 +1,125 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+namespace {
+    // Index of the queue owned by the current thread, workers push and pop their own queue
+    constexpr size_t NOT_A_WORKER{static_cast<size_t>(-1)};
+    thread_local size_t current_worker_index{NOT_A_WORKER};
+}
+
+ThreadPool::ThreadPool(size_t num_threads) {
+    // There is always at least one queue so that jobs can be run by runPendingJob without any workers
+    const size_t num_queues{std::max<size_t>(num_threads, 1)};
+    for (size_t it{0}; it < num_queues; it++) {
+        this->queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    for (size_t it{0}; it < num_threads; it++) {
+        this->workers.emplace_back(&ThreadPool::workerLoop, this, it);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(this->wake_mutex);
+        this->stopping = true;
+    }
+    this->wake_condition.notify_all();
+
+    for (auto& worker : this->workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> job) {
+    size_t queue_index{current_worker_index};
+    if (queue_index == NOT_A_WORKER || queue_index >= this->queues.size()) {
+        queue_index = this->next_queue.fetch_add(1) % this->queues.size();
+    }
+
+    {
+        auto& queue{*this->queues[queue_index]};
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+    {
+        std::lock_guard<std::mutex> lock(this->wake_mutex);
+        this->num_pending++;
+    }
+    this->wake_condition.notify_one();
+}
+
+bool ThreadPool::runPendingJob() {
+    std::function<void()> job;
+    if (!this->stealJob(NOT_A_WORKER, job)) {
+        return false;
+    }
+    this->num_pending--;
+    job();
+    return true;
+}
+
+size_t ThreadPool::getNumThreads() {
+    return this->workers.size();
+}
+
+size_t ThreadPool::defaultNumThreads() {
+    const size_t hardware_threads{std::thread::hardware_concurrency()};
+    return (hardware_threads > 1) ? hardware_threads - 1 : 0;
+}
+
+void ThreadPool::workerLoop(size_t worker_index) {
+    current_worker_index = worker_index;
+
+    while (true) {
+        std::function<void()> job;
+        if (this->popJob(worker_index, job) || this->stealJob(worker_index, job)) {
+            this->num_pending--;
+            job();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(this->wake_mutex);
+        this->wake_condition.wait(lock, [this]() {
+            return this->stopping || this->num_pending > 0;
+        });
+        if (this->stopping) {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::popJob(size_t queue_index, std::function<void()>& job) {
+    auto& queue{*this->queues[queue_index]};
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) {
+        return false;
+    }
+    // Newest jobs first from the thread's own queue, they are the most likely to still be in cache
+    job = std::move(queue.jobs.back());
+    queue.jobs.pop_back();
+    return true;
+}
+
+bool ThreadPool::stealJob(size_t thief_index, std::function<void()>& job) {
+    const size_t num_queues{this->queues.size()};
+    const size_t start{(thief_index == NOT_A_WORKER) ? 0 : thief_index + 1};
+
+    for (size_t it{0}; it < num_queues; it++) {
+        const size_t queue_index{(start + it) % num_queues};
+        if (queue_index == thief_index) {
+            continue;
+        }
+
+        auto& queue{*this->queues[queue_index]};
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            // Oldest jobs first when stealing
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
\ No newline at end of file
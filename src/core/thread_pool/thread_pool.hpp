@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+// Work-stealing thread pool
+// Every worker has its own queue which it takes jobs from the back of, when it runs out it steals
+//  from the front of the other workers' queues. Jobs submitted from a worker go onto its own queue,
+//  jobs submitted from any other thread are spread over the queues
+class ThreadPool {
+public:
+    // One thread is left for the main thread, which can help with runPendingJob
+    ThreadPool(size_t num_threads = ThreadPool::defaultNumThreads());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> job);
+    // Runs one queued job on the calling thread, returns false if there was nothing to run
+    bool runPendingJob();
+
+    size_t getNumThreads();
+    static size_t defaultNumThreads();
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> jobs;
+    };
+
+    void workerLoop(size_t worker_index);
+    bool popJob(size_t queue_index, std::function<void()>& job);
+    bool stealJob(size_t thief_index, std::function<void()>& job);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::atomic<size_t> next_queue{0};
+    // Can briefly go below zero when a job is taken before the submitting thread counts it
+    std::atomic<int> num_pending{0};
+
+    std::mutex wake_mutex;
+    std::condition_variable wake_condition;
+    bool stopping{false};
+};
\ No newline at end of file
@@ -60,6 +60,29 @@ void DebugWindow::showMainWindow() {
     }
     ImGui::SameLine();
     ImGui::Text("%.2f", ImGui::GetIO().Framerate);
+
+    const auto& render_stats = this->game->registry.ctx().at<Renderer&>().getLastFrameStats();
+    ImGui::Text("Draws: %zu Instances: %zu Program switches: %zu", render_stats.draw_calls, render_stats.instances, render_stats.program_switches);
+    ImGui::Text("Uploads: %zu (%zu bytes)", render_stats.buffer_uploads, render_stats.buffer_bytes);
+    const auto& model_stats = this->game->render_system->getFrameModelStats();
+    ImGui::Text("Models recomputed: %zu translated: %zu deferred: %zu", model_stats.recomputed, model_stats.translated, model_stats.deferred);
+
+    auto& post_process_chain = this->game->render_system->getPostProcessChain();
+    for (size_t pass{0}; pass < post_process_chain.getPasses().size(); pass++) {
+        bool is_enabled = post_process_chain.isEnabled(pass);
+        if (ImGui::Checkbox(post_process_chain.getPasses()[pass].name.c_str(), &is_enabled)) {
+            post_process_chain.setEnabled(pass, is_enabled);
+        }
+    }
+
+    const auto& asset_loads = AssetLoadStats::getRecords();
+    if (ImGui::TreeNode("Asset loads", "Asset loads: %zu", asset_loads.size())) {
+        for (const auto& asset_load : asset_loads) {
+            ImGui::Text("%s %zu bytes %.3f ms %zu allocations", 
+                asset_load.path.c_str(), asset_load.bytes, asset_load.load_time, asset_load.allocations);
+        }
+        ImGui::TreePop();
+    }
 }
 
 void DebugWindow::showTextureAtlas() {
@@ -69,16 +92,67 @@ void DebugWindow::showTextureAtlas() {
         ImGuiWindowFlags_NoResize
     )) {
         const float scale = 2.0;
+        if (this->game->texture_atlas.num_pages > 1) {
+            ImGui::SliderInt("Page", &this->atlas_page, 0, this->game->texture_atlas.num_pages - 1);
+        }
+        this->atlas_page = std::clamp(this->atlas_page, 0, std::max(this->game->texture_atlas.num_pages - 1, 0));
+        this->copyAtlasPage(this->atlas_page, this->atlas_page_texture);
         ImGui::Image(
-            (void*)(intptr_t)this->game->texture_atlas.gl_texture_id,
+            (void*)(intptr_t)this->atlas_page_texture,
             {(float)this->game->texture_atlas.width * scale, (float)this->game->texture_atlas.height * scale},
             {0, 0},
             {1, 1}
         );
+
+        auto& texture_atlas = this->game->texture_atlas;
+        bool is_releasing = texture_atlas.getMemoryMode() == AtlasMemoryMode::RELEASE_SOURCES;
+        if (ImGui::Checkbox("Release uploaded pixels", &is_releasing)) {
+            texture_atlas.setMemoryMode(is_releasing ? AtlasMemoryMode::RELEASE_SOURCES : AtlasMemoryMode::KEEP_SOURCES);
+        }
+        const auto memory_stats = texture_atlas.getMemoryStats();
+        for (auto [name, category] : {
+            std::pair{"Sprites", TextureCategory::SPRITE}, 
+            std::pair{"Tiles", TextureCategory::TILE}, 
+            std::pair{"Glyphs", TextureCategory::GLYPH}
+        }) {
+            const auto& category_stats = memory_stats.categories[static_cast<size_t>(category)];
+            ImGui::Text("%s: %zu sources CPU: %zu bytes resident: %zu bytes", 
+                name, category_stats.num_sources, category_stats.source_bytes, category_stats.resident_bytes);
+        }
+        ImGui::Text("Atlas texture: %zu bytes", memory_stats.texture_bytes);
     }
     ImGui::End();
 }
 
+void DebugWindow::copyAtlasPage(int page, GLuint& page_texture) {
+    const auto& texture_atlas = this->game->texture_atlas;
+    if (page >= texture_atlas.num_pages) {
+        return;
+    }
+    if (this->atlas_page_fbos[0] == 0) {
+        glGenFramebuffers(2, this->atlas_page_fbos);
+    }
+    if (page_texture == 0) {
+        glGenTextures(1, &page_texture);
+    }
+    // Reallocated every time so it follows the atlas as it grows
+    glBindTexture(GL_TEXTURE_2D, page_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture_atlas.width, texture_atlas.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, this->atlas_page_fbos[0]);
+    glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture_atlas.gl_texture_id, 0, page);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->atlas_page_fbos[1]);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, page_texture, 0);
+    glBlitFramebuffer(
+        0, 0, texture_atlas.width, texture_atlas.height, 
+        0, 0, texture_atlas.width, texture_atlas.height, 
+        GL_COLOR_BUFFER_BIT, GL_NEAREST
+    );
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
 void DebugWindow::showEntityViewer() {
     if (!this->game->registry.valid(this->selected_entity)) {
         this->selected_entity = entt::null;
@@ -154,8 +228,9 @@ void DebugWindow::showEntityViewer() {
             const float texture_start_y = (float)texture.frame_data->position.y;
             const float texture_end_x = (float)texture.frame_data->position.x + (float)texture.frame_data->size.x;
             const float texture_end_y = (float)texture.frame_data->position.y + (float)texture.frame_data->size.y;
+            this->copyAtlasPage(texture.frame_data->layer, this->entity_page_texture);
             ImGui::Image(
-                (void*)(intptr_t)this->game->texture_atlas.gl_texture_id,
+                (void*)(intptr_t)this->entity_page_texture,
                 {texture.frame_data->size.x * texture_scale, texture.frame_data->size.y * texture_scale},
                 {
                     texture_start_x / (float)this->game->texture_atlas.width,
@@ -309,6 +384,8 @@ void DebugWindow::showShaderViewer() {
                         break;
                 }
             }
+            // The inputs write straight into the uniform buffer, bypassing the dirty tracking
+            this->selected_shader->markUniformsDirty();
         }
         ImGui::EndChild();
         ImGui::BeginChild("error view", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar); 
@@ -21,11 +21,18 @@ private:
     void showTextureAtlas();
     void showEntityViewer();
     void showShaderViewer();
+    // ImGui can only draw 2D textures, so a page of the atlas is copied into one to be shown
+    void copyAtlasPage(int page, GLuint& page_texture);
 
     Game* game;
 
     // Texture atlas
     bool open_texture_atlas = true;
+    int atlas_page{0};
+    GLuint atlas_page_texture{0};
+    // The entity viewer shows its page separately, both images are only drawn at the end of the frame
+    GLuint entity_page_texture{0};
+    GLuint atlas_page_fbos[2]{0, 0};
 
     // Entity Viewer
     bool open_entity_viewer = true;
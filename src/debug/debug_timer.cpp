@@ -4,8 +4,15 @@
 
 bool DebugTimer::open_timers_window = true;
 DebugTimer* DebugTimer::prev_timer = NULL;
+// Static initialization happens on the main thread
+std::thread::id DebugTimer::main_thread_id = std::this_thread::get_id();
 
-DebugTimer::DebugTimer(const char* name) : name{name}, higher_level_timer{DebugTimer::prev_timer} {
+DebugTimer::DebugTimer(const char* name) : name{name} {
+    if (std::this_thread::get_id() != DebugTimer::main_thread_id) {
+        this->on_main_thread = false;
+        return;
+    }
+    this->higher_level_timer = DebugTimer::prev_timer;
     DebugTimer::prev_timer = this;
 
     this->timer_started = DebugTimer::open_timers_window;
@@ -26,6 +33,9 @@ DebugTimer::DebugTimer(const char* name) : name{name}, higher_level_timer{DebugT
 }
 
 DebugTimer::~DebugTimer() {
+    if (!this->on_main_thread) {
+        return;
+    }
     DebugTimer::prev_timer = this->higher_level_timer;
     
     if (DebugTimer::open_timers_window && this->timer_started) {
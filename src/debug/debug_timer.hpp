@@ -2,6 +2,8 @@
 
 #ifndef NDEBUG
 
+#include <thread>
+
 #include <SDL.h>
 
 #include "imgui_impl_opengl3.h"
@@ -14,12 +16,15 @@ public:
 
     static bool open_timers_window;
     static DebugTimer* prev_timer;
+    // Timers only draw from the main thread, ImGui and the timer nesting are not thread safe
+    static std::thread::id main_thread_id;
 private:
     Uint64 start;
     const char* name;
     bool not_collapsed{false};
     bool timer_started{false};
-    DebugTimer* higher_level_timer;
+    bool on_main_thread{true};
+    DebugTimer* higher_level_timer{NULL};
 };
 
 #define DEBUG_TIMER(variable_name, name) auto variable_name{DebugTimer(name)}
@@ -3,15 +3,18 @@
 Game::Game(SDL_Window* window) : window{ window } {
         using namespace entt::literals;
 
-        this->renderable_grid.init(3200, 3200, 16);
-        this->collision_grid.init(3200, 3200, 16);
+        this->renderable_grid.init(16);
+        this->collision_grid.init(16);
 
         this->registry.ctx().emplace<Clock&>(this->clock);
+        this->registry.ctx().emplace<ThreadPool&>(this->thread_pool);
         this->registry.ctx().emplace_hint<Camera&>("world_camera"_hs, this->world_camera);
         this->registry.ctx().emplace_hint<Camera&>("gui_camera"_hs, this->gui_camera);
         this->registry.ctx().emplace<Input&>(this->input_manager);
         this->registry.ctx().emplace<TextureAtlas&>(this->texture_atlas);
         this->registry.ctx().emplace<SpriteSheetAtlas&>(this->sprite_sheet_atlas);
+        // The bundle has to be loaded before anything else is inserted into the atlas
+        this->sprite_sheet_atlas.loadBundle(this->registry, globals::SPRITE_SHEET_BUNDLE);
         this->sprite_sheet_atlas.initMissingTextureSpriteSheet(this->registry, "debug/MissingTexture");
         this->registry.ctx().emplace<ComponentGrid<Renderable>&>(this->renderable_grid);
         this->registry.ctx().emplace<ComponentGrid<Collision>&>(this->collision_grid);
@@ -20,17 +23,24 @@ Game::Game(SDL_Window* window) : window{ window } {
         this->registry.ctx().emplace<ResourceLoader&>(this->resource_loader);
         this->registry.ctx().emplace<TextManager&>(this->text_manager);
 
-        this->systems.push_back(new StateMachineSystem(this->registry));
-        this->systems.push_back(new InputSystem(this->registry));
-        this->systems.push_back(new AnimationSystem(this->registry));
-        this->systems.push_back(new MovementSystem(this->registry));
-        this->systems.push_back(new CollisionSystem(this->registry));
-        this->systems.push_back(new CameraSystem(this->registry));
-        this->systems.push_back(new GuiSystem(this->registry));
+        this->simulation_systems.push_back(new StateMachineSystem(this->registry));
+        this->simulation_systems.push_back(new InputSystem(this->registry));
+        this->simulation_systems.push_back(new MovementSystem(this->registry));
+        this->simulation_systems.push_back(new CollisionSystem(this->registry));
+        // Animations only read the direction of entities, running them after movement and collision lets
+        //  updating animators and textures overlap with those
+        this->simulation_systems.push_back(new AnimationSystem(this->registry));
+        this->frame_systems.push_back(new CameraSystem(this->registry));
+        this->simulation_systems.push_back(new GuiSystem(this->registry));
 
-        auto render_system = new RenderSystem(this->registry);
-        this->screen_texture = render_system->getRenderer()->getScreenTexture();
-        this->systems.push_back(render_system);
+        for (auto system : this->simulation_systems) {
+            this->simulation_scheduler.addSystem(system);
+        }
+
+        this->render_system = new RenderSystem(this->registry);
+        this->screen_texture = this->render_system->getRenderer()->getScreenTexture();
+        this->registry.ctx().emplace<Renderer&>(*this->render_system->getRenderer());
+        this->frame_systems.push_back(this->render_system);
 
         this->text_manager.loadFont("./assets/fonts/cozette/cozette.bdf", "Cozette");
         // Tiled map must be loaded after systems are created in order for observers to be able to
@@ -68,33 +78,70 @@ inline void Game::endFrame() {
     SDL_GL_SwapWindow(this->window);
 }
 
-void Game::mainLoop(void (*debugCallback)()) {
-    while(!this->input_manager.isQuit()) {
-        this->startFrame();
-        {
-            DEBUG_TIMER(_, "Main Loop");
-            {
-                DEBUG_TIMER(context_timer, "Context Updates");
-                this->clock.tick();
-                this->map_loader.loadIfQueued();
-                this->input_manager.update();
-                this->renderable_grid.update();
-                this->collision_grid.update();
-                this->text_manager.update();
-            }
-            {
-                DEBUG_TIMER(systems_timer, "Systems Updates");
-                for (auto system : this->systems) {
-                    system->update();
-                }
-            }   
+void Game::update() {
+    DEBUG_TIMER(_, "Main Loop");
+    {
+        DEBUG_TIMER(context_timer, "Context Updates");
+        this->clock.tick();
+        this->renderable_grid.resetFrameStats();
+        this->collision_grid.resetFrameStats();
+        this->map_loader.loadIfQueued();
+    }
+    {
+        DEBUG_TIMER(simulation_timer, "Simulation Steps");
+        while (this->clock.stepSimulation()) {
+            // Input is polled once per step so that every added and removed key is seen by exactly one step
+            //  If a frame runs no steps, the events are left queued for the next step
+            this->input_manager.update();
+            this->renderable_grid.update();
+            this->collision_grid.update();
+            this->text_manager.update();
+
+            this->simulation_scheduler.update();
+
             auto to_destroy = this->registry.view<Destroy>();
             this->registry.destroy(to_destroy.begin(), to_destroy.end());
-            #ifndef NDEBUG
-                debugCallback();
-            #endif
         }
+    }
+    {
+        DEBUG_TIMER(systems_timer, "Frame Systems Updates");
+        for (auto system : this->frame_systems) {
+            system->update();
+        }
+    }   
+    auto to_destroy = this->registry.view<Destroy>();
+    this->registry.destroy(to_destroy.begin(), to_destroy.end());
+}
+
+void Game::mainLoop(void (*debugCallback)()) {
+    while(!this->input_manager.isQuit()) {
+        this->startFrame();
+        this->update();
+        #ifndef NDEBUG
+            debugCallback();
+        #endif
         this->endFrame();
     }
     SDL_StopTextInput();
+}
+
+std::vector<double> Game::runHeadless(size_t num_frames, InputScript& input_script) {
+    std::vector<double> frame_times;
+    frame_times.reserve(num_frames);
+
+    // Every frame runs exactly one simulation step so that runs are reproducible
+    this->clock.setFixedFrameTime(globals::SIMULATION_TIME_STEP);
+
+    for (size_t frame{0}; frame < num_frames && !this->input_manager.isQuit(); frame++) {
+        input_script.pushEvents(frame);
+
+        const auto start = SDL_GetPerformanceCounter();
+        this->update();
+        const auto end = SDL_GetPerformanceCounter();
+
+        frame_times.push_back((double)(end - start)/SDL_GetPerformanceFrequency()*1000.0);
+        Headless::endFrame();
+    }
+
+    return frame_times;
 }
\ No newline at end of file
@@ -20,6 +20,9 @@
 #include "clock.hpp"
 #include "camera.hpp"
 #include "input.hpp"
+#include "input_script.hpp"
+#include "headless.hpp"
+#include "thread_pool.hpp"
 #include "texture_atlas.hpp"
 #include "sprite_sheet_atlas.hpp"
 #include "shader_manager.hpp"
@@ -38,6 +41,7 @@
 #include "map_loader.hpp"
 #include "text_manager.hpp"
 #include "state_machine_system.hpp"
+#include "system_scheduler.hpp"
 
 #include "debug_timer.hpp"
 
@@ -45,13 +49,24 @@ struct Game {
     Game(SDL_Window* window);
 
     void mainLoop(void (*debugCallback)());
+    // Runs a fixed number of frames with one simulation step each, returns the duration of every frame in ms
+    // Nothing is presented to the window, but with a GL context the last frame can still be read back
+    std::vector<double> runHeadless(size_t num_frames, InputScript& input_script);
+    void update();
 
     inline void startFrame();
     inline void endFrame();
 
     SDL_Window* window;
     entt::registry registry;
-    std::vector<System*> systems;
+    // Simulation systems run once for every fixed simulation step, possibly several times a frame
+    //  Their tasks are run in parallel by the simulation scheduler
+    std::vector<System*> simulation_systems;
+    // Frame systems run once every frame after the simulation steps
+    std::vector<System*> frame_systems;
+
+    ThreadPool thread_pool;
+    SystemScheduler simulation_scheduler{SystemScheduler(this->registry, this->thread_pool)};
 
     Clock clock = Clock();
     Camera world_camera = Camera();
@@ -66,6 +81,8 @@ struct Game {
     TextManager text_manager{TextManager(this->registry)};
 
     GLuint screen_texture;
+    // Owned by frame_systems, kept for its model stats
+    RenderSystem* render_system;
 
     ComponentGrid<Renderable> renderable_grid = ComponentGrid<Renderable>(
         this->registry, [](entt::registry& registry, entt::entity entity) {
@@ -4,6 +4,11 @@
 
 namespace globals {
     const std::string RESOURCE_FOLDER{"./assets/"};
+    // Written by --cook-assets, sprite sheets which are not in it are loaded from their JSON and PNG
+    const std::string SPRITE_SHEET_BUNDLE{RESOURCE_FOLDER + "sprite_sheets.bundle"};
     static const int SCREEN_WIDTH{1440};
     static const int SCREEN_HEIGHT{810};
+    // Simulation systems run at a fixed rate of 60 steps per second, the step is in milliseconds
+    static const double SIMULATION_TIME_STEP{1000.0/60.0};
+    static const int MAX_SIMULATION_STEPS_PER_FRAME{5};
 }
@@ -1,6 +1,13 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <filesystem>
 
 // GLEW must come before OpenGL
 #include <gl\glew.h>
@@ -10,6 +17,14 @@
 #include "game.hpp"
 
 #include "component_grid.hpp"
+#include "render_system.hpp"
+#include "headless.hpp"
+#include "asset_load_stats.hpp"
+#include "input_script.hpp"
+#include "collision_system.hpp"
+#include "collision_boxes.hpp"
+#include "png_writer.hpp"
+#include "stb_image.h"
 
 #ifndef NDEBUG
 	#include "imgui/backends/imgui_impl_opengl3.h"
@@ -25,7 +40,8 @@ SDL_GLContext gl_context;
 #endif
 
 // Initializes SDL, GLEW, then OpenGL
-bool initContext() {
+// A hidden window still gives a context which can be rendered to offscreen
+bool initContext(bool is_hidden = false) {
     bool success = true;
 
     if(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_TIMER) < 0) {
@@ -44,7 +60,7 @@ bool initContext() {
 			globals::SCREEN_WIDTH, 
 			globals::SCREEN_HEIGHT, 
 			SDL_WINDOW_OPENGL | 
-			SDL_WINDOW_SHOWN
+			(is_hidden ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN)
 		);
 
 		SDL_ShowCursor(SDL_DISABLE);
@@ -245,8 +261,397 @@ MessageCallback(
 		( type == GL_DEBUG_TYPE_ERROR ? "** GL ERROR **" : "" );
 }
 
+// Runs the game without a window or GL context and reports frame times and the GPU work that would
+//  have been submitted. Returns non-zero if the average frame time is over the given budget
+// Usage: --headless <num_frames> [input_script] [max_average_frame_ms]
+int runHeadless(int argv, char** args) {
+	if (argv < 3) {
+		std::cerr << "Usage: " << args[0] << " --headless <num_frames> [input_script] [max_average_frame_ms]\n";
+		return 1;
+	}
+	const size_t num_frames = std::strtoul(args[2], NULL, 10);
+	const double max_average_frame_ms = (argv > 4) ? std::strtod(args[4], NULL) : 0.0;
+
+	Headless::enable();
+	if (SDL_Init(SDL_INIT_EVENTS | SDL_INIT_TIMER) < 0) {
+		std::cerr << "SDL could not initialize! SDL Error: " << SDL_GetError() << "\n";
+		return 1;
+	}
+	#ifndef NDEBUG
+		// Debug timers draw to ImGui, which is not initialized when headless
+		DebugTimer::open_timers_window = false;
+	#endif
+
+	InputScript input_script = (argv > 3) ? InputScript(args[3]) : InputScript();
+	std::vector<double> frame_times;
+	double simulation_serial_time{0};
+	double simulation_wall_time{0};
+	ComponentGridStats renderable_grid_stats;
+	ComponentGridStats collision_grid_stats;
+	ModelUpdateStats model_stats;
+	AtlasMemoryStats atlas_memory_stats;
+	{
+		Game game(NULL);
+		frame_times = game.runHeadless(num_frames, input_script);
+		simulation_serial_time = game.simulation_scheduler.getTotalSerialTime();
+		simulation_wall_time = game.simulation_scheduler.getTotalWallTime();
+		renderable_grid_stats = game.renderable_grid.getTotalStats();
+		collision_grid_stats = game.collision_grid.getTotalStats();
+		model_stats = game.render_system->getTotalModelStats();
+		atlas_memory_stats = game.texture_atlas.getMemoryStats();
+	}
+	SDL_Quit();
+
+	if (frame_times.empty()) {
+		std::cerr << "No frames were run\n";
+		return 1;
+	}
+
+	const double average = std::accumulate(frame_times.begin(), frame_times.end(), 0.0)/frame_times.size();
+	std::vector<double> sorted_frame_times{frame_times};
+	std::sort(sorted_frame_times.begin(), sorted_frame_times.end());
+	const double p99 = sorted_frame_times[(sorted_frame_times.size() - 1)*99/100];
+
+	const auto& total = Headless::getTotalStats();
+	const auto frames = frame_times.size();
+	std::cout << "Frames: " << frames << "\n";
+	std::cout << "Frame time (ms) avg: " << average << " min: " << sorted_frame_times.front() << 
+		" max: " << sorted_frame_times.back() << " p99: " << p99 << "\n";
+	std::cout << "Per frame draw calls: " << (double)total.draw_calls/frames << 
+		" instances: " << (double)total.instances/frames << 
+		" program switches: " << (double)total.program_switches/frames << "\n";
+	std::cout << "Per frame buffer uploads: " << (double)total.buffer_uploads/frames << 
+		" bytes: " << (double)total.buffer_bytes/frames << "\n";
+	std::cout << "Total texture uploads: " << total.texture_uploads << 
+		" bytes: " << total.texture_bytes << "\n";
+	std::cout << "Per frame simulation time (ms) serial: " << simulation_serial_time/frames << 
+		" parallel: " << simulation_wall_time/frames << 
+		" speedup: " << ((simulation_wall_time > 0) ? simulation_serial_time/simulation_wall_time : 1.0) << "\n";
+	std::cout << "Per frame models recomputed: " << (double)model_stats.recomputed/frames << 
+		" translated: " << (double)model_stats.translated/frames << 
+		" deferred: " << (double)model_stats.deferred/frames << "\n";
+	for (auto [name, stats] : {
+		std::pair{"Renderable", renderable_grid_stats}, 
+		std::pair{"Collision", collision_grid_stats}
+	}) {
+		std::cout << name << " grid per frame updates: " << (double)stats.updates/frames << 
+			" reinsertions: " << (double)stats.reinsertions/frames << 
+			" skipped: " << (double)stats.skipped_reinsertions/frames << 
+			" chunks: " << stats.chunks << "\n";
+	}
+	for (auto [name, category] : {
+		std::pair{"Sprite", TextureCategory::SPRITE}, 
+		std::pair{"Tile", TextureCategory::TILE}, 
+		std::pair{"Glyph", TextureCategory::GLYPH}
+	}) {
+		const auto& stats = atlas_memory_stats.categories[static_cast<size_t>(category)];
+		std::cout << name << " atlas sources: " << stats.num_sources << 
+			" CPU bytes: " << stats.source_bytes << 
+			" resident bytes: " << stats.resident_bytes << "\n";
+	}
+	std::cout << "Atlas texture bytes: " << atlas_memory_stats.texture_bytes << "\n";
+	const auto& asset_loads = AssetLoadStats::getRecords();
+	std::cout << "Asset loads: " << asset_loads.size() << "\n";
+	for (const auto& asset_load : asset_loads) {
+		std::cout << "\t" << asset_load.path << " bytes: " << asset_load.bytes << 
+			" time (ms): " << asset_load.load_time << 
+			" allocations: " << asset_load.allocations << "\n";
+	}
+
+	if (max_average_frame_ms > 0.0 && average > max_average_frame_ms) {
+		std::cerr << "Average frame time " << average << "ms is over the budget of " << max_average_frame_ms << "ms\n";
+		return 1;
+	}
+	return 0;
+}
+
+// Renders a scripted run of a map with software OpenGL and compares the last frame to a golden image
+// A missing golden image fails the test, goldens are only written when --update-golden is passed last
+// On a mismatch the frame is written next to the golden image as <golden_png>.actual.png
+// The frame times only cover the CPU side of each frame, so they do not depend on the GPU
+// Usage: --render-test <map_tmx> <num_frames> <golden_png> [input_script] [max_differing_pixels] [--update-golden]
+int runRenderTest(int argv, char** args) {
+	const bool is_updating_golden = argv > 1 && !strcmp(args[argv - 1], "--update-golden");
+	if (is_updating_golden) {
+		argv--;
+	}
+	if (argv < 5) {
+		std::cerr << "Usage: " << args[0] << " --render-test <map_tmx> <num_frames> <golden_png> [input_script] [max_differing_pixels] [--update-golden]\n";
+		return 1;
+	}
+	const char* map_path = args[2];
+	const size_t num_frames = std::strtoul(args[3], NULL, 10);
+	const std::string golden_path = args[4];
+	const size_t max_differing_pixels = (argv > 6) ? std::strtoul(args[6], NULL, 10) : 0;
+	// Channels can be off by one between drivers from rounding while blending
+	constexpr int CHANNEL_TOLERANCE{2};
+
+	// Mesa picks llvmpipe, so every machine rasterizes the same way with or without a GPU
+	SDL_setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
+	if (!initContext(true)) {
+		std::cerr << "GL context failed to initialize!\n";
+		return 1;
+	}
+	#ifndef NDEBUG
+		// Debug timers draw to ImGui, which is not initialized for render tests
+		DebugTimer::open_timers_window = false;
+	#endif
+
+	InputScript input_script = (argv > 5) ? InputScript(args[5]) : InputScript();
+	std::vector<double> frame_times;
+	RendererFrameStats render_stats;
+	std::vector<unsigned char> pixels;
+	{
+		Game game(window);
+		game.map_loader.queueLoad(map_path);
+		frame_times = game.runHeadless(num_frames, input_script);
+		Renderer& renderer = game.registry.ctx().at<Renderer&>();
+		render_stats = renderer.getLastFrameStats();
+		renderer.readScreen(pixels);
+	}
+	deinitContext();
+
+	if (frame_times.empty()) {
+		std::cerr << "No frames were run\n";
+		return 1;
+	}
+
+	std::vector<double> sorted_frame_times{frame_times};
+	std::sort(sorted_frame_times.begin(), sorted_frame_times.end());
+	const double average = std::accumulate(frame_times.begin(), frame_times.end(), 0.0)/frame_times.size();
+	std::cout << "Frames: " << frame_times.size() << "\n";
+	std::cout << "Frame time (ms) avg: " << average << " min: " << sorted_frame_times.front() << 
+		" max: " << sorted_frame_times.back() << 
+		" p99: " << sorted_frame_times[(sorted_frame_times.size() - 1)*99/100] << "\n";
+	std::cout << "Last frame draw calls: " << render_stats.draw_calls << 
+		" instances: " << render_stats.instances << 
+		" program switches: " << render_stats.program_switches << "\n";
+
+	if (is_updating_golden) {
+		if (!writePng(golden_path, globals::SCREEN_WIDTH, globals::SCREEN_HEIGHT, pixels.data())) {
+			std::cerr << "Could not write the golden image " << golden_path << "\n";
+			return 1;
+		}
+		std::cout << "Wrote the golden image " << golden_path << "\n";
+		return 0;
+	}
+
+	int golden_width{0};
+	int golden_height{0};
+	int golden_channels{0};
+	unsigned char* golden = stbi_load(golden_path.c_str(), &golden_width, &golden_height, &golden_channels, STBI_rgb_alpha);
+	if (golden == NULL) {
+		const std::string actual_path = golden_path + ".actual.png";
+		writePng(actual_path, globals::SCREEN_WIDTH, globals::SCREEN_HEIGHT, pixels.data());
+		std::cerr << "Missing the golden image " << golden_path << ", the frame was written to " << actual_path << 
+			", run again with --update-golden to accept it\n";
+		return 1;
+	}
+
+	size_t differing_pixels{0};
+	if (golden_width != globals::SCREEN_WIDTH || golden_height != globals::SCREEN_HEIGHT) {
+		differing_pixels = pixels.size()/4;
+	} else {
+		for (size_t pixel{0}; pixel < pixels.size(); pixel += 4) {
+			for (size_t channel{0}; channel < 4; channel++) {
+				if (std::abs(pixels[pixel + channel] - golden[pixel + channel]) > CHANNEL_TOLERANCE) {
+					differing_pixels++;
+					break;
+				}
+			}
+		}
+	}
+	stbi_image_free(golden);
+
+	std::cout << "Differing pixels: " << differing_pixels << "\n";
+	if (differing_pixels > max_differing_pixels) {
+		const std::string actual_path = golden_path + ".actual.png";
+		writePng(actual_path, globals::SCREEN_WIDTH, globals::SCREEN_HEIGHT, pixels.data());
+		std::cerr << differing_pixels << " pixels differ from " << golden_path << ", the frame was written to " << actual_path << "\n";
+		return 1;
+	}
+	return 0;
+}
+
+// Compares the bounding box tests of CollisionSystem::isColliding against the packed boxes and overlap kernel
+// The scene is made of dense clusters, every entity is tested against the rest of its cluster the same
+//  way a crowded grid cell would be. Returns non-zero if the two find a different number of collisions
+// Usage: --collision-benchmark [num_entities] [boxes_per_entity] [iterations]
+int runCollisionBenchmark(int argv, char** args) {
+	const size_t num_entities = (argv > 2) ? std::strtoul(args[2], NULL, 10) : 20000;
+	const size_t boxes_per_entity = (argv > 3) ? std::strtoul(args[3], NULL, 10) : 2;
+	const size_t iterations = (argv > 4) ? std::strtoul(args[4], NULL, 10) : 10;
+	constexpr size_t CLUSTER_SIZE{64};
+	constexpr float CLUSTER_EXTENT{48.0f};
+
+	entt::registry registry;
+	std::vector<entt::entity> entities(num_entities);
+	registry.create(entities.begin(), entities.end());
+
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> position(0.0f, CLUSTER_EXTENT);
+	std::uniform_real_distribution<float> size(2.0f, 12.0f);
+	std::uniform_real_distribution<float> offset(0.0f, 8.0f);
+
+	for (size_t it{0}; it < num_entities; it++) {
+		// Clusters are spread apart so they never overlap each other
+		const float cluster_x = static_cast<float>(it/CLUSTER_SIZE)*CLUSTER_EXTENT*4.0f;
+		auto& spacial = registry.emplace<Spacial>(entities[it]);
+		spacial.position = {cluster_x + position(random), position(random), 0.0f};
+
+		auto& collision = registry.emplace<Collision>(entities[it]);
+		for (size_t box{0}; box < boxes_per_entity; box++) {
+			collision.bounding_boxes.push_back({size(random), size(random), offset(random), offset(random)});
+		}
+	}
+
+	auto time = [iterations](auto func) {
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t it{0}; it < iterations; it++) {
+			func();
+		}
+		const auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::milli>(end - start).count()/iterations;
+	};
+
+	size_t scalar_collisions{0};
+	const double scalar_time = time([&]() {
+		scalar_collisions = 0;
+		for (size_t it{0}; it < num_entities; it++) {
+			const auto [spacial, collision] = registry.get<Spacial, Collision>(entities[it]);
+			const size_t cluster_begin{(it/CLUSTER_SIZE)*CLUSTER_SIZE};
+			const size_t cluster_end{std::min(cluster_begin + CLUSTER_SIZE, num_entities)};
+
+			for (size_t other{cluster_begin}; other < cluster_end; other++) {
+				if (other == it) {
+					continue;
+				}
+				const auto [other_spacial, other_collision] = registry.get<Spacial, Collision>(entities[other]);
+				for (auto bounding_box : collision.bounding_boxes) {
+					for (auto other_bounding_box : other_collision.bounding_boxes) {
+						if (CollisionSystem::isColliding(bounding_box, spacial, other_bounding_box, other_spacial)) {
+							scalar_collisions++;
+						}
+					}
+				}
+			}
+		}
+	});
+
+	CollisionBoxes collision_boxes;
+	const double refresh_time = time([&]() {
+		for (auto entity : entities) {
+			const auto [spacial, collision] = registry.get<Spacial, Collision>(entity);
+			collision_boxes.update(entity, spacial, collision);
+		}
+	});
+
+	size_t kernel_collisions{0};
+	CollisionBoxBatch candidates;
+	std::vector<uint32_t> overlaps;
+	const double kernel_time = time([&]() {
+		kernel_collisions = 0;
+		for (size_t it{0}; it < num_entities; it++) {
+			const size_t cluster_begin{(it/CLUSTER_SIZE)*CLUSTER_SIZE};
+			const size_t cluster_end{std::min(cluster_begin + CLUSTER_SIZE, num_entities)};
+
+			candidates.clear();
+			for (size_t other{cluster_begin}; other < cluster_end; other++) {
+				if (other != it) {
+					collision_boxes.gather(entities[other], candidates);
+				}
+			}
+
+			const auto& slot = collision_boxes.getSlot(entities[it]);
+			for (uint32_t box{slot.offset}; box < slot.offset + slot.count; box++) {
+				kernel_collisions += findOverlappingBoxes(collision_boxes.getEdges(box), candidates, overlaps);
+			}
+		}
+	});
+
+	std::cout << "Entities: " << num_entities << " boxes per entity: " << boxes_per_entity << 
+		" cluster size: " << CLUSTER_SIZE << " kernel: " << getOverlapKernelName() << "\n";
+	std::cout << "isColliding (ms) " << scalar_time << " collisions: " << scalar_collisions << "\n";
+	std::cout << "Packed boxes (ms) " << kernel_time << " collisions: " << kernel_collisions << 
+		" refresh (ms): " << refresh_time << "\n";
+	std::cout << "Speedup: " << ((kernel_time > 0) ? scalar_time/kernel_time : 1.0) << "\n";
+
+	if (scalar_collisions != kernel_collisions) {
+		std::cerr << "The packed boxes found a different number of collisions\n";
+		return 1;
+	}
+	return 0;
+}
+
+// Packs every sprite sheet in the resource folder into a bundle which is loaded with one mapped read at startup
+// Tile sets are found through the maps which use them, any other folder holding {name}/{name}.json is a sprite sheet
+// Usage: --cook-assets <bundle_path>
+int runCookAssets(int argv, char** args) {
+	if (argv < 3) {
+		std::cerr << "Usage: " << args[0] << " --cook-assets <bundle_path>\n";
+		return 1;
+	}
+	// Only the packing is needed, the pages are copied out of the kept sources
+	Headless::enable();
+
+	entt::registry registry;
+	TextureAtlas texture_atlas;
+	texture_atlas.setMemoryMode(AtlasMemoryMode::KEEP_SOURCES);
+	SpriteSheetAtlas sprite_sheet_atlas;
+	registry.ctx().emplace<TextureAtlas&>(texture_atlas);
+	registry.ctx().emplace<SpriteSheetAtlas&>(sprite_sheet_atlas);
+
+	std::vector<std::filesystem::path> maps;
+	std::vector<std::string> sprite_sheet_ids;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(globals::RESOURCE_FOLDER)) {
+		const auto& path = entry.path();
+		if (path.extension() == ".tmx") {
+			maps.push_back(path);
+		} else if (path.extension() == ".json" && path.stem() == path.parent_path().filename()) {
+			auto png_path = path;
+			if (std::filesystem::exists(png_path.replace_extension(".png"))) {
+				sprite_sheet_ids.push_back(std::filesystem::relative(path.parent_path(), globals::RESOURCE_FOLDER).generic_string());
+			}
+		}
+	}
+	// Sorted so the bundle is the same every time it is cooked
+	std::sort(maps.begin(), maps.end());
+	std::sort(sprite_sheet_ids.begin(), sprite_sheet_ids.end());
+
+	// Tile sets go first so they are reported as tiles, initializing a sprite sheet again does nothing
+	for (const auto& map_path : maps) {
+		tmx::Map map;
+		if (!map.load(map_path.string())) {
+			continue;
+		}
+		for (const auto& tile_set : map.getTilesets()) {
+			if (tile_set.getImagePath() != "") {
+				sprite_sheet_atlas.initSpriteSheet(registry, MapLoader::getTileSetResourceId(tile_set), TextureCategory::TILE);
+			}
+		}
+	}
+	for (const auto& sprite_sheet_id : sprite_sheet_ids) {
+		sprite_sheet_atlas.initSpriteSheet(registry, sprite_sheet_id);
+	}
+	texture_atlas.updateAtlas();
+
+	return sprite_sheet_atlas.cookBundle(registry, args[2]) ? 0 : 1;
+}
+
 // Parameters necessary for SDL_Main
 int main(int argv, char** args) {
+	if (argv > 1 && !strcmp(args[1], "--headless")) {
+		return runHeadless(argv, args);
+	}
+	if (argv > 1 && !strcmp(args[1], "--render-test")) {
+		return runRenderTest(argv, args);
+	}
+	if (argv > 1 && !strcmp(args[1], "--collision-benchmark")) {
+		return runCollisionBenchmark(argv, args);
+	}
+	if (argv > 1 && !strcmp(args[1], "--cook-assets")) {
+		return runCookAssets(argv, args);
+	}
 
 	if(!initContext()) {
 		#ifndef NDEBUG
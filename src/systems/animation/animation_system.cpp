@@ -3,14 +3,18 @@
 AnimationSystem::AnimationSystem(entt::registry& registry) : System(registry),
     idle_animation_observer{ entt::observer(registry, entt::collector.group<Texture, IdleAnimation>(entt::exclude<Velocity>)) }, 
     move_animation_observer{ entt::observer(registry, entt::collector.group<Texture, MoveAnimation, Velocity>()) } {
-}
-
-void AnimationSystem::update() {
-    this->updateAnimators();
-    this->updateTextures();
-    
-    this->updateIdleAnimations();
-    this->updateMoveAnimations();
+        // Patching textures feeds observers which check for Spacial, these only read which entities have one
+        this->addTask("AnimationSystem::updateAnimators", [this]() { this->updateAnimators(); })
+            .write<Animator>();
+        this->addTask("AnimationSystem::updateTextures", [this]() { this->updateTextures(); })
+            .read<Animation, Animator>()
+            .write<Texture>();
+        this->addTask("AnimationSystem::updateAnimations", [this]() {
+            this->updateIdleAnimations();
+            this->updateMoveAnimations();
+        })
+            .read<Spacial, Velocity, IdleAnimation, MoveAnimation>()
+            .write<Animation, Animator, Texture>();
 }
 
 void AnimationSystem::updateAnimators() {
@@ -25,12 +29,16 @@ void AnimationSystem::updateAnimators() {
     });
 }
 
-// TODO: only update the textures which had updated animators
 void AnimationSystem::updateTextures() {
-    for (auto entity : this->registry.view<Animation, Texture>()) {
-        this->registry.patch<Texture>(entity, [this, entity](auto& texture){
-            const auto& animation = this->registry.get<Animation>(entity);
-            const auto current_frame = animation.animation_data->frames[animation.animator->current_frame];
+    auto animated_textures = this->registry.view<Animation, Texture>();
+    for (auto entity : animated_textures) {
+        auto [animation, texture] = animated_textures.get<Animation, Texture>(entity);
+        const auto current_frame = animation.animation_data->frames[animation.animator->current_frame];
+        // Every patch has the renderer update the entity's model, so only textures whose frame moved on are patched
+        if (texture.frame_data == current_frame) {
+            continue;
+        }
+        this->registry.patch<Texture>(entity, [current_frame](auto& texture){
             texture.frame_data = current_frame;
         });
     }
@@ -57,6 +65,7 @@ void AnimationSystem::updateIdleAnimations() {
             animation.animator->frame_time = 0;
 
             texture.frame_data = animation.animation_data->frames[0];
+            this->registry.patch<Texture>(entity);
         }
     }
 }
@@ -91,6 +100,7 @@ void AnimationSystem::updateMoveAnimations() {
             } else {
                 texture.frame_data = animation.animation_data->frames[animation.animator->current_frame];
             }
+            this->registry.patch<Texture>(entity);
         }
     }
 }
\ No newline at end of file
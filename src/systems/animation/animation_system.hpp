@@ -19,8 +19,6 @@ class AnimationSystem : public System {
 public: 
     AnimationSystem(entt::registry& registry);
 
-    void update() override;
-
 private:
     void updateAnimators();
     void updateTextures();
@@ -14,7 +14,13 @@ void CameraSystem::updateCameraToController() {
     auto controller_entities = this->registry.view<CameraController, Spacial>();
     auto entity = controller_entities.front();
 
-    auto [cameraController, spacial] = controller_entities.get<CameraController, Spacial>(entity);
+    auto [cameraController, controller_spacial] = controller_entities.get<CameraController, Spacial>(entity);
+
+    // Follow the controller where it is drawn, between its last two simulation steps
+    Spacial spacial{controller_spacial};
+    if (auto interpolation = this->registry.try_get<Interpolation>(entity)) {
+        spacial = interpolateSpacial(controller_spacial, *interpolation, clock.getInterpolationAlpha());
+    }
 
     float x_offset = spacial.dimensions.x * spacial.scale.x / 2;
     float y_offset = spacial.dimensions.y * spacial.scale.y / 2;
@@ -65,7 +71,7 @@ void CameraSystem::updateCameraToControllerSmooth() {
     glm::vec3 target(spacial.position + (glm::vec3(spacial.dimensions, 0) * spacial.scale / 2.0f) + lookahead);
     
     float speed{1.5f};
-    float normalized_speed{std::clamp(static_cast<float>(clock.getDeltaTime() / 1000.0)*speed, 0.0f, 1.0f)};
+    float normalized_speed{std::clamp(static_cast<float>(clock.getFrameDeltaTime() / 1000.0)*speed, 0.0f, 1.0f)};
     // normalized_speed = (normalized_speed > 0.01) ? normalized_speed : 0;
     
     glm::vec3 camera_position = glm::vec3(glm::mix(camera.getPosition(), target, normalized_speed));
@@ -13,6 +13,7 @@
 #include "camera_controller.hpp"
 #include "spacial.hpp"
 #include "velocity.hpp"
+#include "interpolation.hpp"
 
 class CameraSystem : public System {
 
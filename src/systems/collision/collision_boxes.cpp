@@ -0,0 +1,251 @@
+#include "collision_boxes.hpp"
+
+#include <bit>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+#endif
+
+void CollisionBoxBatch::add(const BoxEdges& edges, entt::entity owner) {
+    this->lefts.push_back(edges.left);
+    this->tops.push_back(edges.top);
+    this->rights.push_back(edges.right);
+    this->bottoms.push_back(edges.bottom);
+    this->owners.push_back(owner);
+}
+
+void CollisionBoxBatch::clear() {
+    this->lefts.clear();
+    this->tops.clear();
+    this->rights.clear();
+    this->bottoms.clear();
+    this->owners.clear();
+}
+
+size_t CollisionBoxBatch::size() const {
+    return this->owners.size();
+}
+
+void CollisionBoxes::update(entt::entity entity, const Spacial& spacial, const Collision& collision) {
+    const size_t index = static_cast<size_t>(entt::to_entity(entity));
+    if (index >= this->slots.size()) {
+        this->slots.resize(index + 1);
+    }
+
+    const uint32_t count = static_cast<uint32_t>(collision.bounding_boxes.size());
+    Slot& slot = this->slots[index];
+
+    // A stale slot from a destroyed entity with the same index is reused as is
+    if (count > slot.capacity) {
+        if (slot.capacity > 0) {
+            this->free_ranges.push_back({slot.offset, slot.capacity});
+            this->num_free_boxes += slot.capacity;
+        }
+        slot.offset = this->allocate(count);
+        slot.capacity = count;
+    }
+
+    slot.owner = entity;
+    slot.count = count;
+
+    for (uint32_t it{0}; it < count; it++) {
+        const BoxEdges edges = CollisionBoxes::getEdges(collision.bounding_boxes[it], spacial);
+        this->lefts[slot.offset + it] = edges.left;
+        this->tops[slot.offset + it] = edges.top;
+        this->rights[slot.offset + it] = edges.right;
+        this->bottoms[slot.offset + it] = edges.bottom;
+    }
+}
+
+void CollisionBoxes::remove(entt::entity entity) {
+    const size_t index = static_cast<size_t>(entt::to_entity(entity));
+    if (index >= this->slots.size() || this->slots[index].owner != entity) {
+        return;
+    }
+
+    Slot& slot = this->slots[index];
+    if (slot.capacity > 0) {
+        this->free_ranges.push_back({slot.offset, slot.capacity});
+        this->num_free_boxes += slot.capacity;
+    }
+    slot = Slot();
+
+    if (this->num_free_boxes > 64 && this->num_free_boxes > this->lefts.size()/2) {
+        this->compact();
+    }
+}
+
+void CollisionBoxes::clear() {
+    this->lefts.clear();
+    this->tops.clear();
+    this->rights.clear();
+    this->bottoms.clear();
+    this->slots.clear();
+    this->free_ranges.clear();
+    this->num_free_boxes = 0;
+}
+
+const CollisionBoxes::Slot& CollisionBoxes::getSlot(entt::entity entity) const {
+    static const Slot empty_slot;
+
+    const size_t index = static_cast<size_t>(entt::to_entity(entity));
+    if (index >= this->slots.size() || this->slots[index].owner != entity) {
+        return empty_slot;
+    }
+    return this->slots[index];
+}
+
+BoxEdges CollisionBoxes::getEdges(uint32_t index) const {
+    return {this->lefts[index], this->tops[index], this->rights[index], this->bottoms[index]};
+}
+
+void CollisionBoxes::gather(entt::entity entity, CollisionBoxBatch& batch) const {
+    const Slot& slot = this->getSlot(entity);
+    for (uint32_t it{slot.offset}; it < slot.offset + slot.count; it++) {
+        batch.add(this->getEdges(it), entity);
+    }
+}
+
+BoxEdges CollisionBoxes::getEdges(const glm::vec4& bounding_box, const Spacial& spacial) {
+    // Same order of operations as CollisionSystem::isColliding, so the results match exactly
+    return {
+        spacial.position.x + bounding_box.z,
+        spacial.position.y + bounding_box.w,
+        spacial.position.x + bounding_box.z + bounding_box.x,
+        spacial.position.y + bounding_box.w + bounding_box.y
+    };
+}
+
+uint32_t CollisionBoxes::allocate(uint32_t count) {
+    // First fit, what is left of the range stays free
+    for (auto it = this->free_ranges.begin(); it != this->free_ranges.end(); it++) {
+        if (it->capacity >= count) {
+            const uint32_t offset = it->offset;
+            it->offset += count;
+            it->capacity -= count;
+            this->num_free_boxes -= count;
+            if (it->capacity == 0) {
+                *it = this->free_ranges.back();
+                this->free_ranges.pop_back();
+            }
+            return offset;
+        }
+    }
+
+    const uint32_t offset = static_cast<uint32_t>(this->lefts.size());
+    this->lefts.resize(offset + count);
+    this->tops.resize(offset + count);
+    this->rights.resize(offset + count);
+    this->bottoms.resize(offset + count);
+    return offset;
+}
+
+void CollisionBoxes::compact() {
+    std::vector<float> lefts, tops, rights, bottoms;
+    const size_t num_boxes = this->lefts.size() - this->num_free_boxes;
+    lefts.reserve(num_boxes);
+    tops.reserve(num_boxes);
+    rights.reserve(num_boxes);
+    bottoms.reserve(num_boxes);
+
+    for (auto& slot : this->slots) {
+        if (slot.owner == entt::null) {
+            continue;
+        }
+
+        const uint32_t offset = static_cast<uint32_t>(lefts.size());
+        lefts.insert(lefts.end(), this->lefts.begin() + slot.offset, this->lefts.begin() + slot.offset + slot.count);
+        tops.insert(tops.end(), this->tops.begin() + slot.offset, this->tops.begin() + slot.offset + slot.count);
+        rights.insert(rights.end(), this->rights.begin() + slot.offset, this->rights.begin() + slot.offset + slot.count);
+        bottoms.insert(bottoms.end(), this->bottoms.begin() + slot.offset, this->bottoms.begin() + slot.offset + slot.count);
+        slot.offset = offset;
+        slot.capacity = slot.count;
+    }
+
+    this->lefts = std::move(lefts);
+    this->tops = std::move(tops);
+    this->rights = std::move(rights);
+    this->bottoms = std::move(bottoms);
+    this->free_ranges.clear();
+    this->num_free_boxes = 0;
+}
+
+size_t findOverlappingBoxes(const BoxEdges& box, const CollisionBoxBatch& batch, std::vector<uint32_t>& results) {
+    const size_t count = batch.size();
+    results.resize(count);
+
+    const float* lefts = batch.lefts.data();
+    const float* tops = batch.tops.data();
+    const float* rights = batch.rights.data();
+    const float* bottoms = batch.bottoms.data();
+
+    size_t num_results{0};
+    size_t it{0};
+
+    #if defined(__AVX2__)
+        const __m256 left = _mm256_set1_ps(box.left);
+        const __m256 top = _mm256_set1_ps(box.top);
+        const __m256 right = _mm256_set1_ps(box.right);
+        const __m256 bottom = _mm256_set1_ps(box.bottom);
+
+        for (; it + 8 <= count; it += 8) {
+            const __m256 overlap = _mm256_and_ps(
+                _mm256_and_ps(
+                    _mm256_cmp_ps(bottom, _mm256_loadu_ps(tops + it), _CMP_GT_OQ),
+                    _mm256_cmp_ps(_mm256_loadu_ps(bottoms + it), top, _CMP_GT_OQ)
+                ),
+                _mm256_and_ps(
+                    _mm256_cmp_ps(right, _mm256_loadu_ps(lefts + it), _CMP_GT_OQ),
+                    _mm256_cmp_ps(_mm256_loadu_ps(rights + it), left, _CMP_GT_OQ)
+                )
+            );
+
+            for (unsigned mask = _mm256_movemask_ps(overlap); mask != 0; mask &= mask - 1) {
+                results[num_results++] = static_cast<uint32_t>(it + std::countr_zero(mask));
+            }
+        }
+    #elif defined(__SSE2__) || defined(_M_X64)
+        const __m128 left = _mm_set1_ps(box.left);
+        const __m128 top = _mm_set1_ps(box.top);
+        const __m128 right = _mm_set1_ps(box.right);
+        const __m128 bottom = _mm_set1_ps(box.bottom);
+
+        for (; it + 4 <= count; it += 4) {
+            const __m128 overlap = _mm_and_ps(
+                _mm_and_ps(
+                    _mm_cmpgt_ps(bottom, _mm_loadu_ps(tops + it)),
+                    _mm_cmpgt_ps(_mm_loadu_ps(bottoms + it), top)
+                ),
+                _mm_and_ps(
+                    _mm_cmpgt_ps(right, _mm_loadu_ps(lefts + it)),
+                    _mm_cmpgt_ps(_mm_loadu_ps(rights + it), left)
+                )
+            );
+
+            for (unsigned mask = _mm_movemask_ps(overlap); mask != 0; mask &= mask - 1) {
+                results[num_results++] = static_cast<uint32_t>(it + std::countr_zero(mask));
+            }
+        }
+    #endif
+
+    // Whatever is left over, or everything when there is no SIMD
+    for (; it < count; it++) {
+        if (box.bottom > tops[it] && bottoms[it] > box.top && box.right > lefts[it] && rights[it] > box.left) {
+            results[num_results++] = static_cast<uint32_t>(it);
+        }
+    }
+
+    return num_results;
+}
+
+const char* getOverlapKernelName() {
+    #if defined(__AVX2__)
+        return "AVX2";
+    #elif defined(__SSE2__) || defined(_M_X64)
+        return "SSE";
+    #else
+        return "scalar";
+    #endif
+}
\ No newline at end of file
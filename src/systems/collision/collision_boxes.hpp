@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+
+#include "spacial.hpp"
+#include "collision.hpp"
+
+// World space edges of one bounding box
+struct BoxEdges {
+    float left;
+    float top;
+    float right;
+    float bottom;
+};
+
+// Bounding boxes gathered into contiguous arrays to be tested together
+struct CollisionBoxBatch {
+    std::vector<float> lefts;
+    std::vector<float> tops;
+    std::vector<float> rights;
+    std::vector<float> bottoms;
+    // The entity each box belongs to
+    std::vector<entt::entity> owners;
+
+    void add(const BoxEdges& edges, entt::entity owner);
+    void clear();
+    size_t size() const;
+};
+
+// Packed world space edges of the collision bounding boxes, stored as a structure of arrays
+// The boxes of an entity are contiguous and refreshed whenever its spacial changes, 
+//  so the edges are not recomputed for every pair that is tested
+class CollisionBoxes {
+public:
+    struct Slot {
+        entt::entity owner{entt::null};
+        uint32_t offset{0};
+        uint32_t count{0};
+        uint32_t capacity{0};
+    };
+
+    void update(entt::entity entity, const Spacial& spacial, const Collision& collision);
+    void remove(entt::entity entity);
+    void clear();
+
+    // Entities which were never updated have an empty slot
+    const Slot& getSlot(entt::entity entity) const;
+    BoxEdges getEdges(uint32_t index) const;
+    // Adds the boxes of the entity to the batch
+    void gather(entt::entity entity, CollisionBoxBatch& batch) const;
+
+    static BoxEdges getEdges(const glm::vec4& bounding_box, const Spacial& spacial);
+
+private:
+    struct FreeRange {
+        uint32_t offset;
+        uint32_t capacity;
+    };
+
+    uint32_t allocate(uint32_t count);
+    // Moves every slot to the front of the arrays once too much of them is unused
+    void compact();
+
+    std::vector<float> lefts;
+    std::vector<float> tops;
+    std::vector<float> rights;
+    std::vector<float> bottoms;
+
+    // Indexed by the entity's index
+    std::vector<Slot> slots;
+    std::vector<FreeRange> free_ranges;
+    size_t num_free_boxes{0};
+};
+
+// Writes the indices of the boxes in the batch which overlap the box into results, returns how many there were
+// Edges touching do not count as overlapping, the same as CollisionSystem::isColliding
+// Uses AVX2 or SSE when the build targets them, otherwise one box at a time
+size_t findOverlappingBoxes(const BoxEdges& box, const CollisionBoxBatch& batch, std::vector<uint32_t>& results);
+
+const char* getOverlapKernelName();
\ No newline at end of file
@@ -2,50 +2,243 @@
 
 CollisionSystem::CollisionSystem(entt::registry& registry) : System(registry),
     collision_observer{ entt::observer(registry, entt::collector.update<Spacial>().where<Collision, GridData<Collision>>()) },
-    collider_observer{ entt::observer(registry, entt::collector.update<Collision>().where<Spacial, Collider>()) } {}
+    batched_collision_observer{ registry },
+    collider_observer{ entt::observer(registry, entt::collector.update<Collision>().where<Spacial, Collider>()) } {
+        this->addTask("CollisionSystem::updateCollisions", [this]() {
+            // Events only last until the next update
+            this->registry.clear<CollisionEnter, CollisionExit>();
+            this->removeDestroyedPairs();
+            this->moved_entities.clear();
+            // Swept colliders are stopped first, so the collisions and events describe where they ended up
+            this->gatherMovedEntities();
+            this->resolveSweptCollisions();
+            this->gatherMovedEntities();
+            this->fillCollisions();
+            this->resolveCollisions();
+        })
+            .read<Collider, Collidable, SweptCollision, Interpolation, GridData<Collision>>()
+            .write<Collision, CollisionEnter, CollisionExit, Spacial>();
 
-void CollisionSystem::update() {
-    DEBUG_TIMER(_, "CollisionSystem::update");
-    this->fillCollisions();
-    this->resolveCollisions();
+        registry.on_destroy<Collision>().connect<&CollisionSystem::observeCollisionDestroy>(this);
+}
+
+CollisionSystem::~CollisionSystem() {
+    this->registry.on_destroy<Collision>().disconnect<&CollisionSystem::observeCollisionDestroy>(this);
+}
+
+void CollisionSystem::observeCollisionDestroy(entt::registry& registry, entt::entity entity) {
+    this->collision_boxes.remove(entity);
+    this->destroyed_entities.push_back(entity);
+}
+
+// Drops the contact pairs of entities which lost their collision, the entities still colliding 
+//  with them get an exit event
+void CollisionSystem::removeDestroyedPairs() {
+    if (this->destroyed_entities.empty()) {
+        return;
+    }
+
+    std::sort(this->destroyed_entities.begin(), this->destroyed_entities.end());
+    auto isDestroyed = [this](entt::entity entity) {
+        return std::binary_search(this->destroyed_entities.begin(), this->destroyed_entities.end(), entity);
+    };
+
+    std::erase_if(this->contact_pairs, [this, &isDestroyed](const auto& pair) {
+        if (isDestroyed(pair.first)) {
+            return true;
+        }
+        if (!isDestroyed(pair.second)) {
+            return false;
+        }
+
+        if (this->registry.valid(pair.first) && this->registry.all_of<Collision>(pair.first)) {
+            std::erase(this->registry.get<Collision>(pair.first).collisions, pair.second);
+            this->registry.get_or_emplace<CollisionExit>(pair.first).entities.push_back(pair.second);
+        }
+        return true;
+    });
+
+    this->destroyed_entities.clear();
 }
 #include <iostream>
 // Fill the queries of all entities with collision that have moved
+// The queries and collision tests run in parallel into a buffer per slice of the moved entities, 
+//  the found pairs are then merged and applied on this thread so the patch signals stay single threaded
 void CollisionSystem::fillCollisions() {
-    auto& component_grid = this->registry.ctx().at<ComponentGrid<Collision>&>();
-    std::vector<entt::entity> query_results;
-
-    this->collision_observer.each([this, &component_grid, &query_results](const auto entity) {
-        auto [spacial, collision, grid_data] = this->registry.get<Spacial, Collision, GridData<Collision>>(entity);
-        
-        query_results.clear();
-        component_grid.query(
-            grid_data.bounds,
-            query_results
-        );
+    // Slices smaller than this are not worth the overhead of a job
+    constexpr size_t MIN_ENTITIES_PER_JOB{64};
 
-        collision.collisions.clear();
+    if (this->moved_entities.empty()) {
+        return;
+    }
 
-        for (auto other_entity : query_results) {
-            auto [other_collision, other_spacial] = this->registry.get<Collision, Spacial>(other_entity);
+    auto& thread_pool = this->registry.ctx().at<ThreadPool&>();
+    const size_t num_entities{this->moved_entities.size()};
+    const size_t num_jobs{std::clamp(num_entities/MIN_ENTITIES_PER_JOB, size_t{1}, thread_pool.getNumThreads() + 1)};
+    const size_t entities_per_job{(num_entities + num_jobs - 1)/num_jobs};
 
-            for (auto bounding_box : collision.bounding_boxes) {
-                for (auto other_bounding_box : other_collision.bounding_boxes) {
-                    if (entity != other_entity && this->isColliding(bounding_box, spacial, other_bounding_box, other_spacial)) {
-                        collision.collisions.push_back(other_entity);
-                    }
-                }
+    if (this->pair_buffers.size() < num_jobs) {
+        this->pair_buffers.resize(num_jobs);
+    }
+
+    // The calling thread takes the first slice and helps with the rest while waiting
+    std::atomic<size_t> num_completed{0};
+    for (size_t job{1}; job < num_jobs; job++) {
+        thread_pool.submit([this, job, entities_per_job, num_entities, &num_completed]() {
+            this->findCollisions(job*entities_per_job, std::min((job + 1)*entities_per_job, num_entities), this->pair_buffers[job]);
+            num_completed++;
+        });
+    }
+    this->findCollisions(0, std::min(entities_per_job, num_entities), this->pair_buffers[0]);
+
+    while (num_completed < num_jobs - 1) {
+        if (!thread_pool.runPendingJob()) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Merge the pairs, an entity with several bounding boxes can collide with the same entity more than once
+    this->merged_pairs.clear();
+    for (size_t job{0}; job < num_jobs; job++) {
+        auto& pairs = this->pair_buffers[job].pairs;
+        this->merged_pairs.insert(this->merged_pairs.end(), pairs.begin(), pairs.end());
+    }
+    std::sort(this->merged_pairs.begin(), this->merged_pairs.end());
+    this->merged_pairs.erase(std::unique(this->merged_pairs.begin(), this->merged_pairs.end()), this->merged_pairs.end());
+
+    this->updateContactPairs();
+
+    // Only the lists which changed are rewritten
+    auto pair_it = this->merged_pairs.begin();
+    for (auto entity : this->moved_entities) {
+        auto& collision = this->registry.get<Collision>(entity);
+        const auto pairs_begin = pair_it;
+        while (pair_it != this->merged_pairs.end() && pair_it->first == entity) {
+            pair_it++;
+        }
+
+        const bool is_unchanged = std::equal(
+            collision.collisions.begin(), collision.collisions.end(), pairs_begin, pair_it, 
+            [](auto other_entity, const auto& pair) { return other_entity == pair.second; }
+        );
+        if (!is_unchanged) {
+            collision.collisions.clear();
+            for (auto it = pairs_begin; it != pair_it; it++) {
+                collision.collisions.push_back(it->second);
             }
         }
 
-        if (collision.collisions.size() > 0) {
-            // Allow for updates on collision by other systems when a collision occurs
+        // Allow for updates on collision by other systems when a collision occurs
+        if (pairs_begin != pair_it) {
             this->registry.patch<Collision>(entity);
         }
+    }
+}
+
+void CollisionSystem::updateContactPairs() {
+    // Split the contact pairs into those of the entities that were just tested and those that were not
+    this->previous_pairs.clear();
+    this->kept_pairs.clear();
+    auto moved_it = this->moved_entities.begin();
+    for (const auto& pair : this->contact_pairs) {
+        while (moved_it != this->moved_entities.end() && *moved_it < pair.first) {
+            moved_it++;
+        }
+
+        if (moved_it != this->moved_entities.end() && *moved_it == pair.first) {
+            this->previous_pairs.push_back(pair);
+        } else {
+            this->kept_pairs.push_back(pair);
+        }
+    }
+
+    this->entered_pairs.clear();
+    this->exited_pairs.clear();
+    std::set_difference(
+        this->merged_pairs.begin(), this->merged_pairs.end(), 
+        this->previous_pairs.begin(), this->previous_pairs.end(), 
+        std::back_inserter(this->entered_pairs)
+    );
+    std::set_difference(
+        this->previous_pairs.begin(), this->previous_pairs.end(), 
+        this->merged_pairs.begin(), this->merged_pairs.end(), 
+        std::back_inserter(this->exited_pairs)
+    );
+
+    for (auto [entity, other_entity] : this->entered_pairs) {
+        this->registry.get_or_emplace<CollisionEnter>(entity).entities.push_back(other_entity);
+    }
+    for (auto [entity, other_entity] : this->exited_pairs) {
+        this->registry.get_or_emplace<CollisionExit>(entity).entities.push_back(other_entity);
+    }
+
+    this->contact_pairs.clear();
+    std::merge(
+        this->kept_pairs.begin(), this->kept_pairs.end(), 
+        this->merged_pairs.begin(), this->merged_pairs.end(), 
+        std::back_inserter(this->contact_pairs)
+    );
+}
+
+void CollisionSystem::gatherMovedEntities() {
+    const size_t first_new{this->moved_entities.size()};
+    this->collision_observer.each([this](const auto entity) {
+        this->moved_entities.push_back(entity);
+    });
+    this->batched_collision_observer.each([this](const auto entity) {
+        this->moved_entities.push_back(entity);
     });
+
+    // Refresh the world space boxes before any of them are tested
+    for (size_t it{first_new}; it < this->moved_entities.size(); it++) {
+        const auto entity = this->moved_entities[it];
+        auto [spacial, collision] = this->registry.get<Spacial, Collision>(entity);
+        this->collision_boxes.update(entity, spacial, collision);
+    }
+
+    // An entity can be in both observers, or be gathered again after being swept
+    std::sort(this->moved_entities.begin(), this->moved_entities.end());
+    this->moved_entities.erase(std::unique(this->moved_entities.begin(), this->moved_entities.end()), this->moved_entities.end());
+}
+
+// Only reads the grid and the collision boxes, so several slices can run at once
+void CollisionSystem::findCollisions(size_t begin, size_t end, CollisionPairBuffer& buffer) {
+    const auto& component_grid = this->registry.ctx().at<ComponentGrid<Collision>&>();
+    const auto view = this->registry.view<const GridData<Collision>>();
+
+    buffer.pairs.clear();
+
+    for (size_t it{begin}; it < end; it++) {
+        const auto entity = this->moved_entities[it];
+        const auto& grid_data = view.get<GridData<Collision>>(entity);
+
+        buffer.query_results.clear();
+        component_grid.queryShared(grid_data.bounds, buffer.query_results);
+        // Entities spanning several cells are returned once per cell
+        std::sort(buffer.query_results.begin(), buffer.query_results.end());
+        buffer.query_results.erase(std::unique(buffer.query_results.begin(), buffer.query_results.end()), buffer.query_results.end());
+
+        // Every box of the entity is tested against all of the candidates' boxes at once
+        buffer.candidates.clear();
+        for (auto other_entity : buffer.query_results) {
+            if (entity != other_entity) {
+                this->collision_boxes.gather(other_entity, buffer.candidates);
+            }
+        }
+
+        const auto& slot = this->collision_boxes.getSlot(entity);
+        for (uint32_t box{slot.offset}; box < slot.offset + slot.count; box++) {
+            const size_t num_overlaps = findOverlappingBoxes(this->collision_boxes.getEdges(box), buffer.candidates, buffer.overlaps);
+            for (size_t overlap{0}; overlap < num_overlaps; overlap++) {
+                buffer.pairs.push_back({entity, buffer.candidates.owners[buffer.overlaps[overlap]]});
+            }
+        }
+    }
 }
 
 void CollisionSystem::resolveCollisions() {
+    // Swept colliders were stopped before reaching anything, so they are only pushed out here
+    //  when they were already overlapping something at the start of the step
     for (auto entity : this->collider_observer) {
         auto [collision, spacial] = this->registry.get<Collision, Spacial>(entity);
 
@@ -74,6 +267,142 @@ void CollisionSystem::resolveCollisions() {
     }
 }
 
+// Swept colliders are resolved whether or not they collide where they ended up, since they may have
+//  passed through something on the way
+void CollisionSystem::resolveSweptCollisions() {
+    auto swept_colliders = this->registry.view<SweptCollision, Collider, Collision, Spacial, Interpolation>();
+
+    for (auto [entity, collision, spacial, interpolation] : swept_colliders.each()) {
+        if (spacial.position != interpolation.previous_position) {
+            this->resolveSweptCollision(entity, collision, spacial, interpolation);
+        }
+    }
+}
+
+void CollisionSystem::resolveSweptCollision(entt::entity entity, const Collision& collision, Spacial& spacial, 
+    const Interpolation& interpolation) {
+        // Same as resolveCollision, keeps the entity from still touching what it stopped at
+        const float epsilon = 0.005;
+        // Each iteration slides along the side that was hit, so a corner can take two
+        constexpr int MAX_ITERATIONS{3};
+
+        auto& component_grid = this->registry.ctx().at<ComponentGrid<Collision>&>();
+
+        glm::vec2 position{interpolation.previous_position};
+        glm::vec2 motion{glm::vec2(spacial.position) - position};
+
+        for (int iteration{0}; iteration < MAX_ITERATIONS && motion != glm::vec2(0, 0); iteration++) {
+            Spacial start_spacial{spacial};
+            start_spacial.position = glm::vec3(position, spacial.position.z);
+
+            // Everything within the area covered by the motion
+            float min_x{std::numeric_limits<float>::max()};
+            float min_y{std::numeric_limits<float>::max()};
+            float max_x{std::numeric_limits<float>::lowest()};
+            float max_y{std::numeric_limits<float>::lowest()};
+            for (auto bounding_box : collision.bounding_boxes) {
+                const BoxEdges edges = CollisionBoxes::getEdges(bounding_box, start_spacial);
+                min_x = std::min({min_x, edges.left, edges.left + motion.x});
+                min_y = std::min({min_y, edges.top, edges.top + motion.y});
+                max_x = std::max({max_x, edges.right, edges.right + motion.x});
+                max_y = std::max({max_y, edges.bottom, edges.bottom + motion.y});
+            }
+            if (min_x > max_x) {
+                break;
+            }
+
+            this->swept_candidates.clear();
+            component_grid.query(std::floor(min_x), std::floor(min_y), std::ceil(max_x - min_x) + 1, std::ceil(max_y - min_y) + 1, this->swept_candidates);
+
+            float hit_time{1.0f};
+            glm::vec2 hit_normal{0, 0};
+            for (auto other_entity : this->swept_candidates) {
+                if (other_entity == entity || !this->registry.all_of<Collidable>(other_entity)) {
+                    continue;
+                }
+
+                const auto& slot = this->collision_boxes.getSlot(other_entity);
+                for (auto bounding_box : collision.bounding_boxes) {
+                    const BoxEdges edges = CollisionBoxes::getEdges(bounding_box, start_spacial);
+                    for (uint32_t other_box{slot.offset}; other_box < slot.offset + slot.count; other_box++) {
+                        float time;
+                        glm::vec2 normal;
+                        if (this->sweepBoxes(edges, motion, this->collision_boxes.getEdges(other_box), time, normal) && time < hit_time) {
+                            hit_time = time;
+                            hit_normal = normal;
+                        }
+                    }
+                }
+            }
+
+            if (hit_normal == glm::vec2(0, 0)) {
+                position += motion;
+                break;
+            }
+
+            // Move up to the hit, then keep only the part of the motion along the side that was hit
+            position += motion*hit_time + hit_normal*epsilon;
+            motion *= 1.0f - hit_time;
+            if (hit_normal.x != 0) {
+                motion.x = 0;
+            } else {
+                motion.y = 0;
+            }
+        }
+
+        if (position != glm::vec2(spacial.position)) {
+            // Patch ensures the component_grid gets the update
+            this->registry.patch<Spacial>(entity, [position](auto& spacial) {
+                spacial.position.x = position.x;
+                spacial.position.y = position.y;
+            });
+        }
+}
+
+bool CollisionSystem::sweepBoxes(const BoxEdges& moving, const glm::vec2& motion, const BoxEdges& other, float& time, glm::vec2& normal) {
+    // Time the moving box enters and leaves the other box along each axis, as a fraction of the motion
+    auto axisTimes = [](float moving_min, float moving_max, float other_min, float other_max, float axis_motion, float& entry, float& exit) {
+        if (axis_motion == 0) {
+            if (moving_max <= other_min || other_max <= moving_min) {
+                return false;
+            }
+            entry = -std::numeric_limits<float>::infinity();
+            exit = std::numeric_limits<float>::infinity();
+        } else if (axis_motion > 0) {
+            entry = (other_min - moving_max)/axis_motion;
+            exit = (other_max - moving_min)/axis_motion;
+        } else {
+            entry = (other_max - moving_min)/axis_motion;
+            exit = (other_min - moving_max)/axis_motion;
+        }
+        return true;
+    };
+
+    float entry_x, exit_x, entry_y, exit_y;
+    if (
+        !axisTimes(moving.left, moving.right, other.left, other.right, motion.x, entry_x, exit_x) || 
+        !axisTimes(moving.top, moving.bottom, other.top, other.bottom, motion.y, entry_y, exit_y)
+    ) {
+        return false;
+    }
+
+    const float entry = std::max(entry_x, entry_y);
+    const float exit = std::min(exit_x, exit_y);
+    // Touching edges are not colliding, the same as isColliding
+    // Boxes already overlapping at the start are skipped, resolveCollisions pushes the entity out of those
+    if (entry >= exit || entry < 0 || entry > 1) {
+        return false;
+    }
+
+    time = entry;
+    if (entry_x > entry_y) {
+        normal = {(motion.x > 0) ? -1.0f : 1.0f, 0.0f};
+    } else {
+        normal = {0.0f, (motion.y > 0) ? -1.0f : 1.0f};
+    }
+    return true;
+}
+
 void CollisionSystem::resolveCollision(entt::entity entity, const glm::vec4& collision, Spacial& spacial, 
     const glm::vec4& other_collision, const Spacial& other_spacial) {
 
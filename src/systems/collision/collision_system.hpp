@@ -1,16 +1,32 @@
 #pragma once
 
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+#include <atomic>
+#include <thread>
+#include <limits>
+#include <cmath>
+
 #include <entt/entt.hpp>
 #include <glm/glm.hpp>
 
 #include "system.hpp"
+#include "thread_pool.hpp"
 
 #include "spacial.hpp"
 #include "renderable.hpp"
 #include "component_grid.hpp"
+#include "batched_update.hpp"
 #include "collision.hpp"
+#include "collision_enter.hpp"
+#include "collision_exit.hpp"
+#include "collision_boxes.hpp"
 #include "collider.hpp"
 #include "collidable.hpp"
+#include "swept_collision.hpp"
+#include "interpolation.hpp"
 #include "interaction.hpp"
 #include "interactable.hpp"
 
@@ -19,18 +35,54 @@
 class CollisionSystem : public System {
 public:
     CollisionSystem(entt::registry& registry);
+    ~CollisionSystem();
 
-    void update() override;
+    static bool isColliding(const glm::vec4& collision_1, const Spacial& spacial_1, const glm::vec4& collision_2, const Spacial& spacial_2);
+    // Finds the fraction of the motion at which the moving box first touches the other box and the normal of 
+    //  the side it hits, returns false if it does not hit it during the motion or overlaps it from the start
+    static bool sweepBoxes(const BoxEdges& moving, const glm::vec2& motion, const BoxEdges& other, float& time, glm::vec2& normal);
 
 private:
+    // Collisions found by one slice of the broad-phase, kept between frames to reuse the allocations
+    struct CollisionPairBuffer {
+        std::vector<std::pair<entt::entity, entt::entity>> pairs;
+        std::vector<entt::entity> query_results;
+        CollisionBoxBatch candidates;
+        std::vector<uint32_t> overlaps;
+    };
 
+    void removeDestroyedPairs();
+    // Adds the entities which moved since the last call to moved_entities and refreshes their boxes
+    void gatherMovedEntities();
     void fillCollisions();
-    bool isColliding(const glm::vec4& collision_1, const Spacial& spacial_1, const glm::vec4& collision_2, const Spacial& spacial_2);
+    // Finds the pairs which started and stopped colliding and updates the contact pairs
+    void updateContactPairs();
+    void findCollisions(size_t begin, size_t end, CollisionPairBuffer& buffer);
+    void observeCollisionDestroy(entt::registry& registry, entt::entity entity);
     void resolveCollisions();
+    void resolveSweptCollisions();
+    void resolveSweptCollision(entt::entity entity, const Collision& collision, Spacial& spacial, const Interpolation& interpolation);
     void resolveCollision(entt::entity collider_entity, const glm::vec4& collision, Spacial& spacial, 
         const glm::vec4& other_collision, const Spacial& other_spacial);
     
     entt::observer collision_observer;
+    BatchedObserver<Spacial, Collision, GridData<Collision>> batched_collision_observer;
+
+    // Entities which moved this step, split between the threads for the broad-phase
+    std::vector<entt::entity> moved_entities;
+    std::vector<CollisionPairBuffer> pair_buffers;
+    std::vector<std::pair<entt::entity, entt::entity>> merged_pairs;
+
+    // Every pair colliding as of the last time the first entity moved, sorted
+    // Each entity's part matches its Collision::collisions
+    std::vector<std::pair<entt::entity, entt::entity>> contact_pairs;
+    std::vector<std::pair<entt::entity, entt::entity>> previous_pairs;
+    std::vector<std::pair<entt::entity, entt::entity>> kept_pairs;
+    std::vector<std::pair<entt::entity, entt::entity>> entered_pairs;
+    std::vector<std::pair<entt::entity, entt::entity>> exited_pairs;
+    std::vector<entt::entity> destroyed_entities;
+    std::vector<entt::entity> swept_candidates;
+    CollisionBoxes collision_boxes;
 
     entt::observer collider_observer;
     entt::observer collidable_observer;
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <vector>
+
+#include <entt/entt.hpp>
+
+// Entities this entity stopped colliding with during the last collision update, removed before the next one
+// Like Collision::collisions, only the entity that moved gets the event
+struct CollisionExit {
+    std::vector<entt::entity> entities;
+};
\ No newline at end of file
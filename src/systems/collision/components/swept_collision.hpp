@@ -0,0 +1,6 @@
+#pragma once
+
+// Colliders with this are moved along their motion for the step and stopped at the first collidable
+//  they would hit, instead of being pushed out of what they overlap at the end of the step
+// Fast movers should have it so they cannot pass through thin collidables
+struct SweptCollision {};
\ No newline at end of file
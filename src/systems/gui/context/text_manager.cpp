@@ -3,7 +3,8 @@
 #include <iostream>
 
 TextManager::TextManager(entt::registry& registry) : registry{registry},
-    spacial_observer{entt::observer(registry, entt::collector.update<Spacial>().where<Text>())}
+    spacial_observer{entt::observer(registry, entt::collector.update<Spacial>().where<Text>())},
+    batched_spacial_observer{registry}
 {
     registry.on_construct<Text>().connect<TextManager::emplaceGlyphs>(this);
     registry.on_update<Text>().connect<TextManager::updateGlyphs>(this);
@@ -12,27 +13,34 @@ TextManager::TextManager(entt::registry& registry) : registry{registry},
 
 void TextManager::update() {
     this->spacial_observer.each([this](auto entity) {
-        auto [text, spacial] = this->registry.get<Text, Spacial>(entity);
+        this->updateGlyphPositions(entity);
+    });
+    this->batched_spacial_observer.each([this](auto entity) {
+        this->updateGlyphPositions(entity);
+    });
+}
+
+void TextManager::updateGlyphPositions(entt::entity entity) {
+    auto [text, spacial] = this->registry.get<Text, Spacial>(entity);
 
-        float total_x_offset{0};
-        int character_index{0};
+    float total_x_offset{0};
+    int character_index{0};
+
+    for (auto c : text.text) {
+        FontCharacter& curr_char{this->fonts[text.font_family].characters[c]};
 
-        for (auto c : text.text) {
-            FontCharacter& curr_char{this->fonts[text.font_family].characters[c]};
+        float line_height{8};
 
-            float line_height{8};
+        const glm::vec3 offset{total_x_offset+curr_char.bearing.x, -curr_char.bearing.y + line_height,0};
+        const glm::vec3 new_position{spacial.position+offset};
 
-            const glm::vec3 offset{total_x_offset+curr_char.bearing.x, -curr_char.bearing.y + line_height,0};
-            const glm::vec3 new_position{spacial.position+offset};
+        this->registry.patch<Spacial>(text.glyphs[character_index], [new_position](auto& spacial) {
+            spacial.position = new_position;
+        });
 
-            this->registry.patch<Spacial>(text.glyphs[character_index], [new_position](auto& spacial) {
-                spacial.position = new_position;
-            });
-    
-            total_x_offset += curr_char.advance;
-            character_index++;
-        }
-    });
+        total_x_offset += curr_char.advance;
+        character_index++;
+    }
 }
 
 void TextManager::loadFont(std::string font_path, std::string font_name) {
@@ -82,7 +90,7 @@ void TextManager::loadFont(std::string font_path, std::string font_name) {
         };
 
         font_map.characters[c] = {
-            texture_atlas.insertTexture(glyph_texture),
+            texture_atlas.insertTexture(glyph_texture, TextureCategory::GLYPH),
             glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
             face->glyph->advance.x/64.0f
         };
@@ -22,6 +22,7 @@
 #include "texture_atlas.hpp"
 
 #include "spacial.hpp"
+#include "batched_update.hpp"
 #include "text.hpp"
 #include "renderable.hpp"
 #include "name.hpp"
@@ -62,8 +63,10 @@ private:
     void emplaceGlyphs(entt::registry& registry, entt::entity entity);
     void updateGlyphs(entt::registry& registry, entt::entity entity);
     void destroyGlyphs(entt::registry& registry, entt::entity entity);
+    void updateGlyphPositions(entt::entity entity);
     
     entt::observer spacial_observer;
+    BatchedObserver<Spacial, Text> batched_spacial_observer;
 
     std::unordered_map<std::string, FontMap> fonts;
     entt::registry& registry;
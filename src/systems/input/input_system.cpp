@@ -123,9 +123,8 @@ void InputSystem::updatePlayerControl() {
 void InputSystem::updatePlayerInteract() {
     Input& input_manager = this->registry.ctx().at<Input&>();
 
-    auto collision = this->registry.get<Collision>(this->player_interacter_entity);
-
     if (input_manager.isAdded(SDLK_SPACE) && input_manager.interactionEnabled()) {
+        const auto& collision = this->registry.get<Collision>(this->player_interacter_entity);
         for (auto entity : collision.collisions) {
             if (this->registry.all_of<Interactable>(entity)) {
                 this->registry.get<Interactable>(entity).action(this->registry, entity);
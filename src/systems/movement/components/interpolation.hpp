@@ -0,0 +1,17 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "spacial.hpp"
+
+// Position of a moving entity at the start of the last simulation step
+// Frames rendered between simulation steps blend from it to the current position
+struct Interpolation {
+    glm::vec3 previous_position{0, 0, 0};
+};
+
+inline Spacial interpolateSpacial(const Spacial& spacial, const Interpolation& interpolation, float alpha) {
+    Spacial interpolated_spacial{spacial};
+    interpolated_spacial.position = glm::mix(interpolation.previous_position, spacial.position, alpha);
+    return interpolated_spacial;
+}
\ No newline at end of file
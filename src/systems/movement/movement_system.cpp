@@ -1,20 +1,48 @@
 #include "movement_system.hpp"
 
 MovementSystem::MovementSystem(entt::registry& registry) : System(registry),
-    velocity_observer{ entt::observer(registry, entt::collector.group<Velocity, Spacial>()) } {}
+    velocity_observer{ entt::observer(registry, entt::collector.group<Velocity, Spacial>()) } {
+        // Owning both storages keeps the moving entities packed at the front of each, in the same order
+        this->registry.group<Velocity, Spacial>();
 
-void MovementSystem::update() {
-    DEBUG_TIMER(_, "MovementSystem::update");
-    auto velocity_entities = this->registry.view<Velocity, Spacial>();
+        this->addTask("MovementSystem::updatePositions", [this]() { this->updatePositions(); })
+            .read<Velocity>()
+            .write<Spacial, Interpolation>();
+}
 
-    for (auto entity : velocity_entities) {
+void MovementSystem::updatePositions() {
+    this->updateInterpolations();
 
-        auto& velocity = velocity_entities.get<Velocity>(entity);
-        float delta_time = this->registry.ctx().at<Clock&>().getDeltaTime();
+    auto moving_entities = this->registry.group<Velocity, Spacial>();
+    const float delta_seconds = this->registry.ctx().at<Clock&>().getDeltaTime() / 1000.0f;
 
-        this->registry.patch<Spacial>(entity, [velocity, delta_time](auto &spacial) { 
+    // Spacials are written directly instead of patched, the observers of Spacial are notified once
+    //  for all moved entities through the batched update
+    for (auto [entity, velocity, spacial] : moving_entities.each()) {
+        spacial.position += velocity.components * delta_seconds;
+    }
+
+    this->moved_entities.assign(moving_entities.begin(), moving_entities.end());
+    BatchedUpdate<Spacial>::get(this->registry).publish(this->moved_entities);
+}
 
-            spacial.position += velocity.components * delta_time / 1000.0f;
-        });
+void MovementSystem::updateInterpolations() {
+    // Entities which have come to a stop no longer need to be interpolated
+    std::vector<entt::entity> stopped;
+    this->registry.view<Interpolation, Spacial>(entt::exclude<Velocity>).each([&stopped](auto entity, auto& interpolation, auto& spacial) {
+        if (interpolation.previous_position == spacial.position) {
+            stopped.push_back(entity);
+        }
+    });
+    this->registry.remove<Interpolation>(stopped.begin(), stopped.end());
+
+    std::vector<entt::entity> started;
+    for (auto entity : this->registry.view<Velocity, Spacial>(entt::exclude<Interpolation>)) {
+        started.push_back(entity);
     }
+    this->registry.insert<Interpolation>(started.begin(), started.end());
+
+    this->registry.view<Interpolation, Spacial>().each([](auto& interpolation, auto& spacial) {
+        interpolation.previous_position = spacial.position;
+    });
 }
\ No newline at end of file
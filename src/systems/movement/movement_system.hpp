@@ -7,9 +7,11 @@
 
 #include "velocity.hpp"
 #include "spacial.hpp"
+#include "interpolation.hpp"
 
 #include "clock.hpp"
 #include "component_grid.hpp"
+#include "batched_update.hpp"
 
 #include "debug_timer.hpp"
 
@@ -17,8 +19,10 @@ class MovementSystem : public System {
 public:
     MovementSystem(entt::registry& registry);
 
-    void update() override;
-
 private:
+    void updatePositions();
+    void updateInterpolations();
+
     entt::observer velocity_observer;
+    std::vector<entt::entity> moved_entities;
 };
\ No newline at end of file
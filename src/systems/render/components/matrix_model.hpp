@@ -0,0 +1,9 @@
+#pragma once 
+
+#include <glm/glm.hpp>
+
+// Opt-in for entities rotated around more than the z axis, which the compact Model cannot represent
+// Entities with it are drawn from their full model matrix with the instanced_matrix shader
+struct MatrixModel {
+    glm::mat4 model{1.0f};
+};
\ No newline at end of file
@@ -2,6 +2,17 @@
 
 #include <glm/glm.hpp>
 
+#include "instance.hpp"
+
+// Where the entity's quad is drawn, the texture is only added when it is queued
 struct Model {
-    glm::mat4 model;
-};
\ No newline at end of file
+    // Top left corner, z is the depth the quad is drawn at
+    glm::vec3 position{0, 0, 0};
+    // Radians around the center of the quad
+    float rotation{0};
+    glm::vec2 size{0, 0};
+};
+
+inline Instance getInstance(const Model& model, const glm::vec4& texture_data) {
+    return {model.position, model.rotation, model.size, glm::u16vec4(texture_data)};
+}
\ No newline at end of file
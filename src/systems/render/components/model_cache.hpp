@@ -0,0 +1,18 @@
+#pragma once 
+
+#include <glm/glm.hpp>
+
+#include "atlas_data.hpp"
+
+// What the entity's models were last computed from
+// When only the position changed since then, the models are moved instead of recomputed
+struct ModelCache {
+    const AtlasData* frame_data{nullptr};
+    glm::vec3 scale{1.0f};
+    glm::vec3 rotation{0.0f};
+    float camera_zoom{0.0f};
+    // The position rounded to the pixel grid, both models are kept relative to it
+    glm::vec3 rounded_position{0.0f};
+    glm::vec3 model_offset{0.0f};
+    glm::vec3 matrix_offset{0.0f};
+};
\ No newline at end of file
@@ -0,0 +1,5 @@
+#pragma once
+
+// The entity's Spacial or Texture changed since its Model was last computed
+// Models are only recomputed for entities being drawn, off screen entities keep the mark until they are
+struct ModelDirty {};
\ No newline at end of file
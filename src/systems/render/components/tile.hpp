@@ -1,11 +0,0 @@
-#pragma once
-
-#include <glm/glm.hpp>
-
-#include "texture.hpp"
-
-struct Tile {
-    int gid;
-    glm::vec2 position; // The position of the tile in the texture
-    Texture* tile_set_texture;
-};
\ No newline at end of file
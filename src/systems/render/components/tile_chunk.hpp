@@ -0,0 +1,22 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "texture.hpp"
+#include "static_instances.hpp"
+
+// Static tiles of one tile set within a square of SIZE by SIZE tiles, drawn together from one instance buffer
+// Texture data is relative to the tile set's current frame, which the shader adds as the atlas offset,
+//  so animating the tile set does not change the buffer
+struct TileChunk {
+    static constexpr int SIZE{32};
+
+    Texture* tile_set_texture;
+    // Position in the world and texture data of each tile, used to build the instance buffer
+    std::vector<glm::vec2> positions;
+    std::vector<glm::vec4> texture_data;
+
+    StaticInstances instances;
+};
\ No newline at end of file
@@ -2,12 +2,25 @@
 
 RenderSystem::RenderSystem(entt::registry& registry) : System(registry),
     spacial_observer{entt::observer(registry, entt::collector.update<Spacial>().where<Texture>())},
-    spacial_tile_observer{entt::observer(registry, entt::collector.update<Spacial>().where<Tile>())},
-    texture_observer{entt::observer(registry, entt::collector.update<Texture>().where<Spacial>())} 
+    texture_observer{entt::observer(registry, entt::collector.update<Texture>().where<Spacial>())},
+    batched_spacial_observer{registry}
 {
         this->registry.on_construct<Texture>().connect<&RenderSystem::initModel>();
-        this->registry.on_construct<Tile>().connect<&RenderSystem::initTileModel>();
+        this->registry.on_construct<MatrixModel>().connect<&RenderSystem::initModel>();
+        this->registry.on_destroy<TileChunk>().connect<&RenderSystem::releaseTileChunk>(this);
         auto& shader_manager = this->registry.ctx().at<ShaderManager&>();
+        this->shaders = {
+            shader_manager["instanced"],
+            shader_manager["instanced_matrix"],
+            shader_manager["instanced_tile_chunk"],
+            shader_manager["instanced_sharp_outline"],
+            shader_manager["instanced_dialog_box"],
+            shader_manager["instanced_inline"],
+            shader_manager["screen"],
+            shader_manager["screen_blur"]
+        };
+        // The blur only softens the top and bottom of the screen, half resolution is hardly noticeable there
+        this->post_process_chain.addPass("Blur", this->shaders.screen_blur, 0.5f, false);
 
         MapLoader& map_loader = this->registry.ctx().at<MapLoader&>();
         map_loader.connectAfterLoad<&RenderSystem::clearRenderQueries>(this);
@@ -26,6 +39,18 @@ Renderer* RenderSystem::getRenderer() {
     return &this->renderer;
 }
 
+PostProcessChain& RenderSystem::getPostProcessChain() {
+    return this->post_process_chain;
+}
+
+const ModelUpdateStats& RenderSystem::getFrameModelStats() {
+    return this->frame_model_stats;
+}
+
+const ModelUpdateStats& RenderSystem::getTotalModelStats() {
+    return this->total_model_stats;
+}
+
 void RenderSystem::cullEntities() {
     DEBUG_TIMER(_, "RenderSystem::cullEntities");
 
@@ -41,59 +66,86 @@ void RenderSystem::cullEntities() {
     int w = camera_dimensions.x + 16;
     int h = camera_dimensions.y + 16;
   
-    component_grid.query((lightgrid::bounds) {x,y,w,h}, *this->render_query);
+    this->render_query.clear();
+    component_grid.query((lightgrid::bounds) {x,y,w,h}, this->render_query);
+
+    this->visibility_generation++;
+    if (this->visibility_generation == 0) {
+        // The generation wrapped around, so old stamps could match again
+        this->visibility_stamps.assign(this->visibility_stamps.size(), VisibilityStamp());
+        this->visibility_generation = 1;
+    }
+    const uint32_t last_generation{this->visibility_generation - 1};
+
+    this->entering_entities.clear();
+    this->entering_tiles.clear();
+    this->leaving_entities.clear();
 
-    std::vector<entt::entity> diff;
     {
-        DEBUG_TIMER(set_difference_timer, "RenderSystem::cullEntities - set difference");
-        // Get the entities which were in the new query but not in the last query
-        std::set_difference(this->render_query->begin(), this->render_query->end(),
-            this->last_render_query->begin(), this->last_render_query->end(),
-            std::back_inserter(diff)
-        );
-    }
+        DEBUG_TIMER(visibility_diff_timer, "RenderSystem::cullEntities - visibility diff");
+        // Stamp the entities which are visible now, the ones without last frame's stamp have just entered
+        for (auto entity : this->render_query) {
+            const size_t index = static_cast<size_t>(entt::to_entity(entity));
+            if (index >= this->visibility_stamps.size()) {
+                this->visibility_stamps.resize(index + 1);
+            }
+
+            auto& stamp = this->visibility_stamps[index];
+            if (stamp.entity != entity || stamp.generation != last_generation) {
+                if (this->registry.all_of<TileChunk>(entity)) {
+                    this->entering_tiles.push_back(entity);
+                } else {
+                    this->entering_entities.push_back(entity);
+                }
+            }
+            stamp = {entity, this->visibility_generation};
+        }
 
-    for (auto entity : diff) {
-        if (this->registry.all_of<Tile>(entity)) {
-            this->registry.emplace<ToRenderTile>(entity);
-        } else {
-            this->registry.emplace<ToRender>(entity);
+        // The entities from last frame which did not get this frame's stamp have left
+        for (auto entity : this->last_render_query) {
+            const auto& stamp = this->visibility_stamps[static_cast<size_t>(entt::to_entity(entity))];
+            if ((stamp.entity != entity || stamp.generation != this->visibility_generation) && this->registry.valid(entity)) {
+                this->leaving_entities.push_back(entity);
+            }
         }
     }
-    diff.clear();
 
-    // auto total =  (SDL_GetPerformanceCounter() - start)/SDL_GetPerformanceFrequency()*1000.0;
-    // Get the entities which were in the last query but not in the new query
-    std::set_difference(this->last_render_query->begin(), this->last_render_query->end(),
-        this->render_query->begin(), this->render_query->end(),
-        std::back_inserter(diff)
-    );
-
-    for (auto entity : diff) {
-        this->registry.remove<ToRender>(entity);
-        this->registry.remove<ToRenderTile>(entity);
-    }
+    this->registry.insert<ToRender>(this->entering_entities.begin(), this->entering_entities.end());
+    this->registry.insert<ToRenderTile>(this->entering_tiles.begin(), this->entering_tiles.end());
+    this->registry.remove<ToRender>(this->leaving_entities.begin(), this->leaving_entities.end());
+    this->registry.remove<ToRenderTile>(this->leaving_entities.begin(), this->leaving_entities.end());
 
     std::swap(this->last_render_query, this->render_query);
-    render_query->clear();
 }
 
 void RenderSystem::sortEntities() {
     DEBUG_TIMER(_, "RenderSystem::sortEntities");
     // Sort sprites by Spacial y-pos before rendering
     // Tiles don't need to be sorted
-    this->registry.sort<ToRender>([this](const entt::entity lhs, const entt::entity rhs) {
-        auto lhSpacial = this->registry.get<Spacial>(lhs);
-        auto rhSpacial = this->registry.get<Spacial>(rhs);
-        
-        return (lhSpacial.position.y + lhSpacial.dimensions.y) * ((lhSpacial.position.z + 1)*10) < (rhSpacial.position.y + rhSpacial.dimensions.y) * ((rhSpacial.position.z + 1)*10);
+    // The keys are read once per entity, and the radix sort costs the same however shuffled they are
+    this->draw_order.clear();
+    // Model is part of the view so the sprites drawn from the sorted order are guaranteed to have one
+    this->registry.view<Spacial, Texture, Model, ToRender>(entt::exclude<Text>).use<ToRender>().each([this](const auto entity, auto& spacial, auto&, auto&) {
+        this->draw_order.push_back({RenderSystem::getDrawOrderKey(spacial), entity});
+    });
+
+    const auto by_key = [](const DrawOrderEntry& lhs, const DrawOrderEntry& rhs) { return lhs.key < rhs.key; };
+    // Most frames nothing crosses, so checking first is cheaper than a sort
+    if (!std::is_sorted(this->draw_order.begin(), this->draw_order.end(), by_key)) {
+        radixSort(this->draw_order, this->draw_order_scratch, [](const DrawOrderEntry& entry) { return entry.key; });
+    }
+}
 
-    }, entt::insertion_sort {}); // Insertion sort is much faster as the spacials will generally be "mostly sorted"
+uint64_t RenderSystem::getDrawOrderKey(const Spacial& spacial) {
+    const uint64_t depth = getRadixKey(spacial.position.z);
+    const uint64_t bottom = getRadixKey(spacial.position.y + spacial.dimensions.y);
+    return (depth << 32) | bottom;
 }
 
 void RenderSystem::clearRenderQueries(entt::registry& registry) {
-    this->render_query->clear();
-    this->last_render_query->clear();
+    this->render_query.clear();
+    this->last_render_query.clear();
+    this->visibility_stamps.clear();
     this->registry.clear<ToRender>();
     this->registry.clear<ToRenderTile>();
 }
@@ -102,35 +154,96 @@ void RenderSystem::updateModels() {
     DEBUG_TIMER(_, "RenderSystem::updateModels");
     using namespace entt::literals;
     Camera& camera = registry.ctx().at<Camera&>("world_camera"_hs);
-    // TDOD: Consider only updating models of entities which need rendering
+    this->frame_model_stats = ModelUpdateStats();
 
     {
-        DEBUG_TIMER(spacial_observer_timer, "Spacial Observer");
-        // Update the models of all the entities whose spacials have been changed
-        this->spacial_observer.each([this, &camera](entt::entity entity){
-            auto [spacial, texture] = this->registry.get<Spacial, Texture>(entity);
-            this->registry.emplace_or_replace<Model>(entity, RenderSystem::getModel(spacial, texture, camera.getZoom()));
-        });
+        DEBUG_TIMER(model_observer_timer, "Model Observers");
+        // Changes are only marked here, an entity changed several times is updated once
+        // Spacials and textures are patched by tasks which may run at the same time, so each is
+        //  collected by its own observer and they are only merged here on the main thread
+        auto mark_dirty = [this](entt::entity entity){
+            if (!this->registry.all_of<ModelDirty>(entity)) {
+                this->registry.emplace<ModelDirty>(entity);
+            }
+        };
+        this->spacial_observer.each(mark_dirty);
+        this->texture_observer.each(mark_dirty);
+        this->batched_spacial_observer.each(mark_dirty);
     }
     {
-        DEBUG_TIMER(spacial_tile_observer_timer, "Spacial Tile Observer");
-        this->spacial_tile_observer.each([this, &camera](entt::entity entity) {
-            auto spacial = this->registry.get<Spacial>(entity);
-            this->registry.emplace_or_replace<Model>(entity, RenderSystem::getTileModel(spacial));
-        });
+        DEBUG_TIMER(dirty_models_timer, "Dirty Models");
+        // Only the models about to be drawn are updated, the rest stay dirty until they come into view
+        this->updated_models.clear();
+        for (auto entity : this->registry.view<ModelDirty>()) {
+            if (!this->registry.all_of<Spacial, Texture>(entity)) {
+                this->updated_models.push_back(entity);
+                continue;
+            }
+            if (!this->registry.any_of<ToRender, GuiElement, DialogChild>(entity)) {
+                this->frame_model_stats.deferred++;
+                continue;
+            }
+            // Interpolated models are recomputed below regardless
+            if (!this->registry.all_of<Interpolation, ToRender>(entity)) {
+                auto [spacial, texture] = this->registry.get<Spacial, Texture>(entity);
+                this->updateCachedModel(entity, spacial, texture, camera.getZoom());
+            }
+            this->updated_models.push_back(entity);
+        }
+        this->registry.remove<ModelDirty>(this->updated_models.begin(), this->updated_models.end());
     }
     {
-        DEBUG_TIMER(texture_observer_timer, "Texture Observer");
-        // ...and same for models with updated textures
-        // TODO: Consider ways of avoiding overlap between these two groups
-        this->texture_observer.each([this, &camera](entt::entity entity){
-            auto [spacial, texture] = this->registry.get<Spacial, Texture>(entity);
-            this->registry.emplace_or_replace<Model>(entity, RenderSystem::getModel(spacial, texture, camera.getZoom()));
+        DEBUG_TIMER(interpolation_timer, "Interpolation");
+        // Moving entities are drawn between their last two simulation steps
+        const float alpha = this->registry.ctx().at<Clock&>().getInterpolationAlpha();
+        this->registry.view<Spacial, Texture, Interpolation, ToRender>().each([this, &camera, alpha](auto entity, auto& spacial, auto& texture, auto& interpolation) {
+            const Spacial interpolated_spacial = interpolateSpacial(spacial, interpolation, alpha);
+            this->updateCachedModel(entity, interpolated_spacial, texture, camera.getZoom());
         });
     }
+
+    this->total_model_stats.recomputed += this->frame_model_stats.recomputed;
+    this->total_model_stats.translated += this->frame_model_stats.translated;
+    this->total_model_stats.deferred += this->frame_model_stats.deferred;
+}
+
+void RenderSystem::updateCachedModel(entt::entity entity, const Spacial& spacial, const Texture& texture, const float camera_zoom) {
+    const glm::vec3 rounded_position = RenderSystem::getRoundedPosition(spacial.position, camera_zoom);
+    auto* cache = this->registry.try_get<ModelCache>(entity);
+    if (cache && this->registry.all_of<Model>(entity) &&
+        cache->frame_data == texture.frame_data && 
+        cache->scale == spacial.scale && 
+        cache->rotation == spacial.rotation && 
+        cache->camera_zoom == camera_zoom
+    ) {
+        if (cache->rounded_position == rounded_position) {
+            return;
+        }
+        // Only the position changed, so both models are moved rather than rebuilt
+        cache->rounded_position = rounded_position;
+        this->registry.get<Model>(entity).position = rounded_position + cache->model_offset;
+        if (auto* matrix_model = this->registry.try_get<MatrixModel>(entity)) {
+            matrix_model->model[3] = glm::vec4(rounded_position + cache->matrix_offset, 1.0f);
+        }
+        this->frame_model_stats.translated++;
+        return;
+    }
+
+    RenderSystem::updateModel(this->registry, entity, spacial, texture, camera_zoom);
+    ModelCache updated_cache{texture.frame_data, spacial.scale, spacial.rotation, camera_zoom, rounded_position};
+    updated_cache.model_offset = this->registry.get<Model>(entity).position - rounded_position;
+    if (auto* matrix_model = this->registry.try_get<MatrixModel>(entity)) {
+        updated_cache.matrix_offset = glm::vec3(matrix_model->model[3]) - rounded_position;
+    }
+    this->registry.emplace_or_replace<ModelCache>(entity, updated_cache);
+    this->frame_model_stats.recomputed++;
+}
+
+glm::vec3 RenderSystem::getRoundedPosition(const glm::vec3 position, const float camera_zoom) {
+    return glm::vec3(glm::ivec3(position*camera_zoom) + glm::ivec3(0.5, 0.5, 0))/camera_zoom;
 }
 
-glm::mat4 RenderSystem::getModel(
+Model RenderSystem::getModel(
     const Spacial& spacial,  
     const glm::vec2 texture_size, 
     const glm::vec2 texture_offsets, 
@@ -138,6 +251,25 @@ glm::mat4 RenderSystem::getModel(
 ) {
     // The model does not represent the physical location exactly, but the rendered location
     //  Information from the texture is needed so that the sprite can be placed correctly
+    const glm::vec3 scale_vector = spacial.scale;
+    const glm::vec2 size_vector = glm::vec2(scale_vector)*texture_size;
+
+    const glm::vec3 offset = glm::vec3(texture_offsets.x, texture_offsets.y, 0) * scale_vector;
+
+    const glm::vec3 normalized_position = RenderSystem::getRoundedPosition(spacial.position, camera_zoom);
+
+    Model model{normalized_position + offset, spacial.rotation.z, size_vector};
+    // The quad's verticies are at a depth of one before scaling
+    model.position.z += scale_vector.z;
+    return model;
+}
+
+glm::mat4 RenderSystem::getMatrixModel(
+    const Spacial& spacial,  
+    const glm::vec2 texture_size, 
+    const glm::vec2 texture_offsets, 
+    const float camera_zoom
+) {
     glm::mat4 rotate = glm::mat4(1.0f);
     
     rotate = glm::rotate(rotate, spacial.rotation.x, glm::vec3(1, 0, 0));
@@ -152,9 +284,7 @@ glm::mat4 RenderSystem::getModel(
 
     const glm::vec3 offset = glm::vec3(texture_offsets.x, texture_offsets.y, 0) * scale_vector;
 
-    // Help prevent texture bleeding by rounding to full pixels
-    // The camera rounds to a full pixel, while this rounds to a pixel plus half a pixel
-    const glm::vec3 normalized_position = glm::vec3(glm::ivec3(spacial.position*camera_zoom) + glm::ivec3(0.5, 0.5, 0))/camera_zoom;
+    const glm::vec3 normalized_position = RenderSystem::getRoundedPosition(spacial.position, camera_zoom);
 
     const glm::mat4 translate = glm::translate(glm::mat4(1), normalized_position + offset);
 
@@ -165,7 +295,7 @@ glm::mat4 RenderSystem::getModel(
     return (translate * uncenter * rotate * center * scale);
 }
 
-glm::mat4 RenderSystem::getModel(const Spacial& spacial, const Texture& texture, const float camera_zoom) {
+Model RenderSystem::getModel(const Spacial& spacial, const Texture& texture, const float camera_zoom) {
     return RenderSystem::getModel(
         spacial, 
         {texture.frame_data->size.x, texture.frame_data->size.y}, 
@@ -174,37 +304,56 @@ glm::mat4 RenderSystem::getModel(const Spacial& spacial, const Texture& texture,
     );
 }
 
-glm::mat4 RenderSystem::getTileModel(const Spacial& spacial) {
-    return RenderSystem::getModel(spacial);
+void RenderSystem::updateModel(entt::registry& registry, entt::entity entity, const Spacial& spacial, const Texture& texture, const float camera_zoom) {
+    registry.emplace_or_replace<Model>(entity, RenderSystem::getModel(spacial, texture, camera_zoom));
+
+    if (auto* matrix_model = registry.try_get<MatrixModel>(entity)) {
+        matrix_model->model = RenderSystem::getMatrixModel(
+            spacial, 
+            {texture.frame_data->size.x, texture.frame_data->size.y}, 
+            {texture.frame_data->offset.x, texture.frame_data->offset.y}, 
+            camera_zoom
+        );
+    }
 }
 
-glm::mat4 RenderSystem::getModel(const Spacial& spacial) {
-    const glm::vec3 dimensions_vector = glm::vec3(spacial.dimensions.x, spacial.dimensions.y, 1);
-    const glm::mat4 scale = glm::scale(glm::mat4(1), dimensions_vector);
+Model RenderSystem::getTileModel(const Spacial& spacial) {
+    return RenderSystem::getModel(spacial);
+}
 
+Model RenderSystem::getModel(const Spacial& spacial) {
     // Help prevent texture bleeding by rounding to full pixels
     // The camera rounds to a full pixel, while this rounds to a pixel plus half a pixel
     const glm::vec3 normalized_position = glm::vec3(glm::ivec3(spacial.position) + glm::ivec3(0.5, 0.5, 0));
-    const glm::mat4 translate = glm::translate(glm::mat4(1), normalized_position);
 
-    // Order matters
-    return (translate * scale);
+    // The quad's verticies are at a depth of one
+    return {normalized_position + glm::vec3(0, 0, 1), 0, spacial.dimensions};
 }
 
 void RenderSystem::initModel(entt::registry& registry, entt::entity entity) {
     using namespace entt::literals;
     Camera& camera = registry.ctx().at<Camera&>("world_camera"_hs);
-    if (registry.all_of<Spacial>(entity)) {
+    if (registry.all_of<Spacial, Texture>(entity)) {
         auto [spacial, texture] = registry.get<Spacial, Texture>(entity);
-        registry.emplace_or_replace<Model>(entity, RenderSystem::getModel(spacial, texture, camera.getZoom()));
+        RenderSystem::updateModel(registry, entity, spacial, texture, camera.getZoom());
+        // The models were rebuilt outside of the cache
+        registry.remove<ModelCache>(entity);
+    }
+}
+
+void RenderSystem::uploadTileChunk(TileChunk& tile_chunk) {
+    std::vector<Instance> instances;
+    instances.reserve(tile_chunk.positions.size());
+    for (size_t it{0}; it < tile_chunk.positions.size(); it++) {
+        const Model model = RenderSystem::getTileModel(Spacial{glm::vec3(tile_chunk.positions[it], 0), glm::vec2(16, 16)});
+        instances.push_back(getInstance(model, tile_chunk.texture_data[it]));
     }
+
+    this->renderer.uploadStaticInstances(tile_chunk.instances, instances);
 }
 
-void RenderSystem::initTileModel(entt::registry& registry, entt::entity entity) {
-    if (registry.all_of<Spacial>(entity)) {
-        auto spacial = registry.get<Spacial>(entity);
-        registry.emplace_or_replace<Model>(entity, RenderSystem::getTileModel(spacial));
-    } 
+void RenderSystem::releaseTileChunk(entt::registry& registry, entt::entity entity) {
+    this->renderer.releaseStaticInstances(registry.get<TileChunk>(entity).instances);
 }
 
 void RenderSystem::render() {
@@ -214,143 +363,88 @@ void RenderSystem::render() {
     auto& texture_atlas = this->registry.ctx().at<TextureAtlas&>();
     auto& clock = this->registry.ctx().at<Clock&>();
 
-    shader_manager.setAllUniforms("atlas_texture", texture_atlas.gl_texture_id);
-    shader_manager.setAllUniforms("atlas_dimensions", glm::vec2(texture_atlas.width, texture_atlas.height));
-    shader_manager.setAllUniforms("screen_resolution", glm::vec2(globals::SCREEN_WIDTH, globals::SCREEN_HEIGHT));
-    shader_manager.setAllUniforms("time", (float)clock.getCumulativeTime());
-
     using namespace entt::literals;
+    shader_manager.setAllUniforms("atlas_texture"_hs, texture_atlas.gl_texture_id);
+    this->renderer.setFrameUniforms(glm::vec2(texture_atlas.width, texture_atlas.height), (float)clock.getCumulativeTime());
+
     Camera& camera = registry.ctx().at<Camera&>("world_camera"_hs);
     Camera& gui_camera = registry.ctx().at<Camera&>("gui_camera"_hs);
 
-    { // Render background tiles and normal entities
-        shader_manager["instanced"]->setUniform("P", camera.getProjectionMatrix());
-        shader_manager["instanced"]->setUniform("V", camera.getViewMatrix());
-        shader_manager["instanced"]->setUniform("camera_zoom", camera.getZoom());
+    // The GUI is still scaled by the world camera's zoom
+    this->renderer.setView(WORLD_VIEW, {camera.getProjectionMatrix(), camera.getViewMatrix(), camera.getZoom()});
+    this->renderer.setView(GUI_VIEW, {gui_camera.getProjectionMatrix(), gui_camera.getViewMatrix(), camera.getZoom()});
 
+    // Every pass is queued into one command buffer, the renderer sorts them by layer and draws them in one go
+    { // Render background tiles and normal entities
         // Tiles need to be rendered under the other textures
-        this->registry.view<Model, Tile, ToRenderTile>().each([this, &shader_manager](auto& model, auto& tile) {  
-            glm::vec4 texture_data = glm::vec4(
-                tile.tile_set_texture->frame_data->position.x + tile.position.x, 
-                tile.tile_set_texture->frame_data->position.y + tile.position.y, 
-                16, 16
-            );
-            this->renderer.queue(texture_data, model.model, shader_manager["instanced"]);
-        });
+        // Baked chunks draw straight from their own buffers, the tile set's frame moves them through the animation
+        ShaderProgram* tile_chunk_shader = this->shaders.instanced_tile_chunk;
+        this->registry.view<TileChunk, ToRenderTile>().each([this, tile_chunk_shader](auto& tile_chunk) {
+            if (!tile_chunk.instances.is_uploaded) {
+                this->uploadTileChunk(tile_chunk);
+            }
 
-        this->registry.view<Texture, Model, ToRender>(entt::exclude<Text, Tile>).use<ToRender>().each([this, &shader_manager](const auto entity, auto& texture, auto& model) {  
-            glm::vec4 texture_data = glm::vec4(texture.frame_data->position.x, texture.frame_data->position.y, 
-                texture.frame_data->size.x, texture.frame_data->size.y
-            );
-            this->renderer.queue(texture_data, model.model, shader_manager["instanced"]);
+            tile_chunk.instances.atlas_offset = glm::vec2(getTextureData(*tile_chunk.tile_set_texture->frame_data));
+            this->renderer.queue(tile_chunk.instances, tile_chunk_shader, {TILE_CHUNK_LAYER, 0, WORLD_VIEW});
         });
 
-        this->renderer.render();
+        // Sprites keep their sorted order as their depth, so switching shaders can not reorder them
+        uint32_t depth{0};
+        for (const auto& entry : this->draw_order) {
+            const entt::entity entity = entry.entity;
+            auto [texture, model] = this->registry.get<Texture, Model>(entity);
+            const glm::vec4 texture_data = getTextureData(*texture.frame_data);
+            const RenderKey key{SPRITE_LAYER, depth++, WORLD_VIEW};
+            // Checked per entity rather than with a separate view to keep the sorted order
+            if (const auto* matrix_model = this->registry.try_get<MatrixModel>(entity)) {
+                this->renderer.queue(texture_data, matrix_model->model, this->shaders.instanced_matrix, key);
+            } else {
+                this->renderer.queue(getInstance(model, texture_data), this->shaders.instanced, key);
+            }
+        }
     }
 
     { // Render outlines
-        shader_manager["instanced_sharp_outline"]->setUniform("P", camera.getProjectionMatrix());
-        shader_manager["instanced_sharp_outline"]->setUniform("V", camera.getViewMatrix());
-        shader_manager["instanced_sharp_outline"]->setUniform("camera_zoom", camera.getZoom());
-
-        this->registry.view<Texture, Model, ToRender, Outline>(entt::exclude<Text, Tile>).use<ToRender>().each([this, &shader_manager, &camera](const auto entity, auto& texture, auto& model) {  
-            glm::vec4 texture_data = glm::vec4(texture.frame_data->position.x, texture.frame_data->position.y, 
-                texture.frame_data->size.x, texture.frame_data->size.y
-            );
+        this->registry.view<Spacial, Texture, Model, ToRender, Outline>(entt::exclude<Text>).use<ToRender>().each([this, &camera](auto& spacial, auto& texture, auto&) {  
+            const glm::vec4 texture_data = getTextureData(*texture.frame_data);
             // To change the width, the shader would also need to be updated
             int border_width = 1;
             glm::vec2 size = texture.frame_data->size + border_width*2;
             glm::vec2 offsets = texture.frame_data->offset - border_width;
-            auto spacial = registry.get<Spacial>(entity);
-            const glm::mat4 outline_model = RenderSystem::getModel(spacial, size, offsets, camera.getZoom());
+            const Model outline_model = RenderSystem::getModel(spacial, size, offsets, camera.getZoom());
             
-            this->renderer.queue(texture_data, outline_model, shader_manager["instanced_sharp_outline"]);
+            this->renderer.queue(getInstance(outline_model, texture_data), this->shaders.instanced_sharp_outline, {OUTLINE_LAYER, 0, WORLD_VIEW});
         });
-
-        this->renderer.render();
     }
 
     { // Render text boxes
         // Stencil testing will mask out text not within the text box
-        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE); // Do not draw any pixels on the back buffer
-        glEnable(GL_STENCIL_TEST); 
-        glStencilFunc(GL_ALWAYS, 1, 0xFF); // Do not test the current value in the stencil buffer, always accept any value on there for drawing
-        glStencilMask(0xFF);
-        glStencilOp(GL_REPLACE, GL_REPLACE, GL_REPLACE); // Make every test succeed
-
-        shader_manager["instanced_dialog_box"]->setUniform("P", gui_camera.getProjectionMatrix());
-        shader_manager["instanced_dialog_box"]->setUniform("V", gui_camera.getViewMatrix());
-        shader_manager["instanced_dialog_box"]->setUniform("camera_zoom", camera.getZoom());
-
-        this->registry.view<Spacial, Dialog, GuiElement>().each([this, &shader_manager](const auto entity, auto& spacial, auto& dialog) {  
-            glm::vec4 texture_data = glm::vec4(
-                0, 0, 
-                spacial.dimensions.x, spacial.dimensions.y
-            );
-            this->renderer.queue(texture_data, RenderSystem::getModel(spacial), shader_manager["instanced_dialog_box"]);
-        });
-
-        this->renderer.render();
-
-        glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP); // Make sure you will no longer (over)write stencil values, even if any test succeeds
-        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE); // Make sure we draw on the backbuffer again.
-
-        glStencilFunc(GL_EQUAL, 1, 0xFF); // Now we will only draw pixels where the corresponding stencil buffer value equals 1
-
-        Camera& gui_camera = registry.ctx().at<Camera&>("gui_camera"_hs);
-        shader_manager["instanced_dialog_box"]->setUniform("P", gui_camera.getProjectionMatrix());
-        shader_manager["instanced_dialog_box"]->setUniform("V", gui_camera.getViewMatrix());
-        shader_manager["instanced_dialog_box"]->setUniform("camera_zoom", camera.getZoom());
-
-        this->registry.view<Spacial, Dialog, GuiElement>().each([this, &shader_manager](const auto entity, auto& spacial, auto& dialog) {  
+        this->registry.view<Spacial, Dialog, GuiElement>().each([this](const auto entity, auto& spacial, auto& dialog) {  
             glm::vec4 texture_data = glm::vec4(
                 0, 0, 
                 spacial.dimensions.x, spacial.dimensions.y
             );
-            this->renderer.queue(texture_data, RenderSystem::getModel(spacial), shader_manager["instanced_dialog_box"]);
+            const Instance instance = getInstance(RenderSystem::getModel(spacial), texture_data);
+            this->renderer.queue(instance, this->shaders.instanced_dialog_box, {DIALOG_MASK_LAYER, 0, GUI_VIEW, StencilState::WRITE});
+            this->renderer.queue(instance, this->shaders.instanced_dialog_box, {DIALOG_BOX_LAYER, 0, GUI_VIEW, StencilState::TEST});
         });
 
-        this->renderer.render();
-
-        shader_manager["instanced"]->setUniform("P", gui_camera.getProjectionMatrix());
-        shader_manager["instanced"]->setUniform("V", gui_camera.getViewMatrix());
-        shader_manager["instanced"]->setUniform("camera_zoom", camera.getZoom());
-
-        this->registry.view<Texture, Model, DialogChild>().each([this, &shader_manager](const auto entity, auto& texture, auto& model) {  
-            glm::vec4 texture_data = glm::vec4(texture.frame_data->position.x, texture.frame_data->position.y, 
-                texture.frame_data->size.x, texture.frame_data->size.y
-            );
-            this->renderer.queue(texture_data, model.model, shader_manager["instanced"]);
+        this->registry.view<Texture, Model, DialogChild>().each([this](const auto entity, auto& texture, auto& model) {  
+            const glm::vec4 texture_data = getTextureData(*texture.frame_data);
+            this->renderer.queue(getInstance(model, texture_data), this->shaders.instanced, {DIALOG_CHILD_LAYER, 0, GUI_VIEW, StencilState::TEST});
         });
-
-        this->renderer.render();
-
-        glDisable(GL_STENCIL_TEST);
     }
 
     { // Render other GUI elements
-        Camera& gui_camera = registry.ctx().at<Camera&>("gui_camera"_hs);
-        shader_manager["instanced"]->setUniform("P", gui_camera.getProjectionMatrix());
-        shader_manager["instanced"]->setUniform("V", gui_camera.getViewMatrix());
-        shader_manager["instanced"]->setUniform("camera_zoom", camera.getZoom());
-
-        this->registry.view<Texture, Model, GuiElement>().each([this, &shader_manager](const auto entity, auto& texture, auto& model) {  
-            glm::vec4 texture_data = glm::vec4(texture.frame_data->position.x, texture.frame_data->position.y, 
-                texture.frame_data->size.x, texture.frame_data->size.y
-            );
-            this->renderer.queue(texture_data, model.model, shader_manager["instanced"]);
+        this->registry.view<Texture, Model, GuiElement>().each([this](const auto entity, auto& texture, auto& model) {  
+            const glm::vec4 texture_data = getTextureData(*texture.frame_data);
+            this->renderer.queue(getInstance(model, texture_data), this->shaders.instanced, {GUI_LAYER, 0, GUI_VIEW});
         });
-
-        this->renderer.render();
     }
 
     #ifndef NDEBUG
     { // Render collision boxes
-        shader_manager["instanced_inline"]->setUniform("P", camera.getProjectionMatrix());
-        shader_manager["instanced_inline"]->setUniform("V", camera.getViewMatrix());
-        shader_manager["instanced_inline"]->setUniform("camera_zoom", camera.getZoom());
-
-        this->registry.view<Collision, Spacial, RenderCollision>().each([this, &shader_manager](
+        this->registry.view<Collision, Spacial, RenderCollision>().each([this](
             const auto entity, 
             auto& collision, 
             auto& spacial
@@ -361,17 +455,20 @@ void RenderSystem::render() {
                     collision_bounds.x, collision_bounds.y
                 );
                 
-                glm::vec3 dimensions_vector = glm::vec3(collision_bounds.x, collision_bounds.y, 1);
-                glm::mat4 scale = glm::scale(glm::mat4(1), spacial.scale*dimensions_vector);
                 glm::vec3 offset = glm::vec3(collision_bounds.z, collision_bounds.w, 0);
-                glm::mat4 translate = glm::translate(glm::mat4(1), spacial.position + (offset*spacial.scale));
+                Model model{
+                    spacial.position + (offset*spacial.scale) + glm::vec3(0, 0, spacial.scale.z), 
+                    0, 
+                    glm::vec2(spacial.scale)*glm::vec2(collision_bounds.x, collision_bounds.y)
+                };
 
-                this->renderer.queue(texture_data, translate * scale * glm::mat4(1), shader_manager["instanced_inline"]);
+                this->renderer.queue(getInstance(model, texture_data), this->shaders.instanced_inline, {COLLISION_LAYER, 0, WORLD_VIEW});
             }
         });
-        this->renderer.render();
     }
     #endif
 
-    this->renderer.present(shader_manager["screen"]);
+    this->renderer.render();
+    this->renderer.renderPostProcessing(this->post_process_chain);
+    this->renderer.present(this->shaders.screen);
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once 
 
 #include <algorithm>
+#include <vector>
 
 #include <entt\entt.hpp>
 
@@ -11,23 +12,29 @@
 #include "texture.hpp"
 #include "spacial.hpp"
 #include "model.hpp"
+#include "matrix_model.hpp"
 #include "camera_controller.hpp"
 #include "animation.hpp"
 #include "text.hpp"
 #include "to_render.hpp"
 #include "to_render_tile.hpp"
-#include "tile.hpp"
+#include "tile_chunk.hpp"
 #include "renderable.hpp"
 #include "collision.hpp"
 #include "outline.hpp"
 #include "gui_element.hpp"
 #include "dialog.hpp"
+#include "interpolation.hpp"
+#include "model_dirty.hpp"
+#include "model_cache.hpp"
 
 #include "renderer.hpp"
 #include "camera.hpp"
 #include "clock.hpp"
 #include "texture_atlas.hpp"
 #include "component_grid.hpp"
+#include "batched_update.hpp"
+#include "radix_sort.hpp"
 #include "shader_manager.hpp"
 #include "sprite_sheet_atlas.hpp"
 #include "map_loader.hpp"
@@ -37,41 +44,130 @@
 #include "debug_timer.hpp"
 #include "render_collision.hpp"
 
+// Counts of how entity models were brought up to date
+// Translated models only had their position moved, deferred models were dirty but not drawn
+struct ModelUpdateStats {
+    size_t recomputed{0};
+    size_t translated{0};
+    size_t deferred{0};
+};
+
 class RenderSystem : public System {
 public:
     RenderSystem(entt::registry& registry);
 
     void update() override;
     Renderer* getRenderer();
+    PostProcessChain& getPostProcessChain();
+
+    // Frame stats count the model updates of the last update
+    const ModelUpdateStats& getFrameModelStats();
+    const ModelUpdateStats& getTotalModelStats();
 
 private:
+    // Passes in the order they are drawn
+    enum Layers : uint8_t {
+        TILE_CHUNK_LAYER,
+        SPRITE_LAYER,
+        OUTLINE_LAYER,
+        // Dialog boxes are first drawn into the stencil buffer, masking out their text past the box
+        DIALOG_MASK_LAYER,
+        DIALOG_BOX_LAYER,
+        DIALOG_CHILD_LAYER,
+        GUI_LAYER,
+        COLLISION_LAYER
+    };
+
+    enum Views : uint8_t {
+        WORLD_VIEW,
+        GUI_VIEW
+    };
+
     void cullEntities();
     void sortEntities();
+    // Sprites are drawn by z, then by the y of their bottom edge, packed into one key
+    static uint64_t getDrawOrderKey(const Spacial& spacial);
     void clearRenderQueries(entt::registry& registry);
 
     void updateModels();
+    // Brings the models up to date with the spacial, only moving them when nothing but the position changed
+    void updateCachedModel(entt::entity entity, const Spacial& spacial, const Texture& texture, const float camera_zoom);
 
-    static glm::mat4 getModel(const Spacial& spacial, const Texture& texture, const float camera_zoom);
-    static glm::mat4 getModel(
+    static Model getModel(const Spacial& spacial, const Texture& texture, const float camera_zoom);
+    static Model getModel(
+        const Spacial& spacial,  
+        const glm::vec2 texture_size, 
+        const glm::vec2 texture_offsets, 
+        const float camera_zoom
+    );
+    static Model getModel(const Spacial& spacial);
+    static Model getTileModel(const Spacial& spacial);
+    // Help prevent texture bleeding by rounding to full pixels
+    // The camera rounds to a full pixel, while this rounds to a pixel plus half a pixel
+    static glm::vec3 getRoundedPosition(const glm::vec3 position, const float camera_zoom);
+    // The full model matrix, only kept for entities with a MatrixModel
+    static glm::mat4 getMatrixModel(
         const Spacial& spacial,  
         const glm::vec2 texture_size, 
         const glm::vec2 texture_offsets, 
         const float camera_zoom
     );
-    static glm::mat4 getModel(const Spacial& spacial);
-    static glm::mat4 getTileModel(const Spacial& spacial);
+    static void updateModel(entt::registry& registry, entt::entity entity, const Spacial& spacial, const Texture& texture, const float camera_zoom);
 
     static void initModel(entt::registry& registry, entt::entity entity);
-    static void initTileModel(entt::registry& registry, entt::entity entity);
+
+    void uploadTileChunk(TileChunk& tile_chunk);
+    void releaseTileChunk(entt::registry& registry, entt::entity entity);
 
     void render();
 
+    // Entities whose spacial or texture changed, one observer per component since they are patched
+    //  by tasks which run at the same time
     entt::observer spacial_observer;
-    entt::observer spacial_tile_observer;
     entt::observer texture_observer;
-
-    std::set<entt::entity>* render_query{new std::set<entt::entity>};
-    std::set<entt::entity>* last_render_query{new std::set<entt::entity>};
+    BatchedObserver<Spacial, Texture> batched_spacial_observer;
+
+    // The last generation an entity was visible in, indexed by the entity's index
+    // The entity is kept to tell apart a newer entity reusing the index
+    struct VisibilityStamp {
+        entt::entity entity{entt::null};
+        uint32_t generation{0};
+    };
+
+    std::vector<VisibilityStamp> visibility_stamps;
+    uint32_t visibility_generation{0};
+    std::vector<entt::entity> render_query;
+    std::vector<entt::entity> last_render_query;
+    std::vector<entt::entity> entering_entities;
+    std::vector<entt::entity> entering_tiles;
+    std::vector<entt::entity> leaving_entities;
+    std::vector<entt::entity> updated_models;
+
+    struct DrawOrderEntry {
+        uint64_t key;
+        entt::entity entity;
+    };
+
+    // The visible sprites in the order they are drawn
+    std::vector<DrawOrderEntry> draw_order;
+    std::vector<DrawOrderEntry> draw_order_scratch;
+
+    ModelUpdateStats frame_model_stats;
+    ModelUpdateStats total_model_stats;
+
+    // Resolved once rather than looked up by name for every queued quad
+    struct Shaders {
+        ShaderProgram* instanced;
+        ShaderProgram* instanced_matrix;
+        ShaderProgram* instanced_tile_chunk;
+        ShaderProgram* instanced_sharp_outline;
+        ShaderProgram* instanced_dialog_box;
+        ShaderProgram* instanced_inline;
+        ShaderProgram* screen;
+        ShaderProgram* screen_blur;
+    } shaders;
+
+    PostProcessChain post_process_chain;
 
     Renderer renderer;
 };
\ No newline at end of file
@@ -2,11 +2,20 @@
 
 in vec2 texture_coords; // Value from 0-1
 in vec4 texture_data; // x, y, width, height
+flat in float texture_layer;
 
 out vec4 color;
 
-uniform sampler2D atlas_texture;
-uniform vec2 atlas_dimensions;
+uniform sampler2DArray atlas_texture;
+// Shared by every shader, uploaded once per frame for each camera
+layout(std140) uniform FrameUniforms {
+    mat4 P;
+    mat4 V;
+    vec2 atlas_dimensions;
+    vec2 screen_resolution;
+    float camera_zoom;
+    float time;
+};
 
 void main() {
     // The number of pixels of border space given by the vertex shader
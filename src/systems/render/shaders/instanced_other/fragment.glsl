@@ -2,12 +2,20 @@
 
 in vec2 texture_coords; // Value from 0-1
 in vec4 texture_data; // x, y, width, height
+flat in float texture_layer;
 
 out vec4 color;
 
-uniform sampler2D atlas_texture;
-uniform vec2 atlas_dimensions;
-
+uniform sampler2DArray atlas_texture;
+// Shared by every shader, uploaded once per frame for each camera
+layout(std140) uniform FrameUniforms {
+    mat4 P;
+    mat4 V;
+    vec2 atlas_dimensions;
+    vec2 screen_resolution;
+    float camera_zoom;
+    float time;
+};
 
 void main() {
     float bleed_offset = 0.00001; // There may be a better solution that exists to avoid texture bleeding
@@ -19,5 +27,5 @@ void main() {
     float y_percentage = texture_data.w/atlas_dimensions.y - 2*bleed_offset;
     float y_offset = texture_data.y/atlas_dimensions.y + bleed_offset + some_x_offset_i_dont_understand;
 
-    color = texture(atlas_texture, vec2(texture_coords.x*x_percentage + x_offset, texture_coords.y*y_percentage + y_offset));
+    color = texture(atlas_texture, vec3(texture_coords.x*x_percentage + x_offset, texture_coords.y*y_percentage + y_offset, texture_layer));
 }  
\ No newline at end of file
@@ -1,13 +1,23 @@
 #version 330 core
 layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
 layout (location = 1) in vec4 instance_texture_data; // 
-layout (location = 3) in mat4 instance_model;
+layout (location = 2) in vec4 instance_position; // <vec3 top left corner, float rotation>
+layout (location = 3) in vec2 instance_size;
 
 out vec2 texture_coords;
 out vec4 texture_data;
+// The page of the atlas the texture is on
+flat out float texture_layer;
 
-uniform mat4 V;
-uniform mat4 P;
+// Shared by every shader, uploaded once per frame for each camera
+layout(std140) uniform FrameUniforms {
+    mat4 P;
+    mat4 V;
+    vec2 atlas_dimensions;
+    vec2 screen_resolution;
+    float camera_zoom;
+    float time;
+};
 
 void main() {
 	float pixel_scale = 3;
@@ -16,11 +26,19 @@ void main() {
 
 	vec4 scale_up = vec4(mix(-xs, xs, vertex.x), -mix(-ys, ys, vertex.y), 0, 0);
 
-	texture_data = instance_texture_data;
+	// The atlas layer is packed above the x position, see AtlasData::LAYER_STRIDE
+	texture_layer = floor(instance_texture_data.x/4096.0);
+	texture_data = vec4(instance_texture_data.x - texture_layer*4096.0, instance_texture_data.yzw);
 	texture_coords = vertex.zw;
 
 	// The verticies need to be scaled up so that the borders are drawable
 
+	// Scale the quad to its size, then rotate it around its center
+	vec2 center = instance_size/2.0;
+	float cos_rotation = cos(instance_position.w);
+	float sin_rotation = sin(instance_position.w);
+	vec2 quad_position = center + mat2(cos_rotation, sin_rotation, -sin_rotation, cos_rotation)*(vertex.xy*instance_size - center);
+
 	// Output position of the vertex, in clip space : MVP * position
-	gl_Position =  P*V*instance_model * vec4(vertex.xy, 1.0, 1.0) + scale_up;
+	gl_Position =  P*V*vec4(instance_position.xy + quad_position, instance_position.z, 1.0) + scale_up;
 }
\ No newline at end of file
@@ -0,0 +1,23 @@
+#version 330 core
+
+in vec2 texture_coords; // Value from 0-1
+in vec4 texture_data; // x, y, width, height
+flat in float texture_layer;
+
+out vec4 color;
+
+uniform sampler2DArray atlas_texture;
+// Shared by every shader, uploaded once per frame for each camera
+layout(std140) uniform FrameUniforms {
+    mat4 P;
+    mat4 V;
+    vec2 atlas_dimensions;
+    vec2 screen_resolution;
+    float camera_zoom;
+    float time;
+};
+
+void main() {
+    vec2 sample_pixel_center = texture_data.xy + vec2(ivec2(texture_coords*texture_data.zw)) + vec2(0.5, 0.5);
+    color = texture(atlas_texture, vec3(sample_pixel_center/atlas_dimensions, texture_layer));
+}  
\ No newline at end of file
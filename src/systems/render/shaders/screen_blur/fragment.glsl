@@ -3,15 +3,23 @@ in vec2 TexCoords;
 out vec4 color;
 
 uniform sampler2D screen_texture;
-uniform float time;
-
-uniform vec2 screen_resolution;
+// Shared by every shader, uploaded once per frame for each camera
+layout(std140) uniform FrameUniforms {
+    mat4 P;
+    mat4 V;
+    vec2 atlas_dimensions;
+    vec2 screen_resolution;
+    float camera_zoom;
+    float time;
+};
 
 void main() {
     vec2 pos = TexCoords;
     float r = 10;
-    float xs = screen_resolution.x;
-    float ys = screen_resolution.y;
+    // The pass can be drawn below the screen resolution, so the step is one texel of the source
+    vec2 source_size = vec2(textureSize(screen_texture, 0));
+    float xs = source_size.x;
+    float ys = source_size.y;
     float x,y,xx,yy,rr=r*r,dx,dy,w,w0;
     w0=0.3780/pow(r,1.975);
     vec2 p;
@@ -3,8 +3,15 @@ in vec2 TexCoords;
 out vec4 color;
 
 uniform sampler2D screen_texture;
-uniform vec2 screen_resolution;
-uniform float time;
+// Shared by every shader, uploaded once per frame for each camera
+layout(std140) uniform FrameUniforms {
+    mat4 P;
+    mat4 V;
+    vec2 atlas_dimensions;
+    vec2 screen_resolution;
+    float camera_zoom;
+    float time;
+};
 
 // uniform float density;
 // uniform float opacity_scanline;
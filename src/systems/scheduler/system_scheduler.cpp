@@ -0,0 +1,182 @@
+#include "system_scheduler.hpp"
+
+SystemScheduler::SystemScheduler(entt::registry& registry, ThreadPool& thread_pool) : 
+    registry{registry}, thread_pool{thread_pool} {}
+
+void SystemScheduler::addSystem(System* system) {
+    this->systems.push_back(system);
+    this->graph_dirty = true;
+}
+
+void SystemScheduler::update() {
+    if (this->graph_dirty) {
+        this->buildGraph();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    if (this->parallel) {
+        this->runParallel();
+    } else {
+        this->runSerial();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    this->last_wall_time = std::chrono::duration<double, std::milli>(end - start).count();
+    this->last_serial_time = 0;
+    for (const auto& node : this->nodes) {
+        this->last_serial_time += node.duration;
+    }
+    this->total_wall_time += this->last_wall_time;
+    this->total_serial_time += this->last_serial_time;
+}
+
+void SystemScheduler::setParallel(bool parallel) {
+    this->parallel = parallel;
+}
+
+bool SystemScheduler::isParallel() {
+    return this->parallel;
+}
+
+double SystemScheduler::getLastSerialTime() {
+    return this->last_serial_time;
+}
+
+double SystemScheduler::getLastWallTime() {
+    return this->last_wall_time;
+}
+
+double SystemScheduler::getLastSpeedup() {
+    return (this->last_wall_time > 0) ? this->last_serial_time / this->last_wall_time : 1.0;
+}
+
+double SystemScheduler::getTotalSerialTime() {
+    return this->total_serial_time;
+}
+
+double SystemScheduler::getTotalWallTime() {
+    return this->total_wall_time;
+}
+
+void SystemScheduler::buildGraph() {
+    std::vector<SystemTask*> tasks;
+    this->wrapper_tasks.clear();
+
+    for (auto system : this->systems) {
+        if (system->getTasks().empty()) {
+            auto& wrapper_task = this->wrapper_tasks.emplace_back("System::update", [system]() { 
+                system->update(); 
+            });
+            wrapper_task.exclusive().mainThread();
+            tasks.push_back(&wrapper_task);
+        } else {
+            for (auto& task : system->getTasks()) {
+                tasks.push_back(&task);
+            }
+        }
+    }
+
+    this->nodes = std::vector<Node>(tasks.size());
+    for (size_t it{0}; it < tasks.size(); it++) {
+        auto& node{this->nodes[it]};
+        node.task = tasks[it];
+
+        // Storages are created up front, creating them while tasks run in parallel would modify the registry
+        for (auto assure_storage : node.task->storages) {
+            assure_storage(this->registry);
+        }
+
+        for (size_t other{0}; other < it; other++) {
+            if (SystemScheduler::isConflicting(*tasks[other], *node.task)) {
+                this->nodes[other].dependents.push_back(it);
+                node.num_dependencies++;
+            }
+        }
+    }
+
+    this->graph_dirty = false;
+}
+
+bool SystemScheduler::isConflicting(const SystemTask& task, const SystemTask& other_task) {
+    if (task.is_exclusive || other_task.is_exclusive) {
+        return true;
+    }
+
+    auto intersects = [](const std::vector<entt::id_type>& lhs, const std::vector<entt::id_type>& rhs) {
+        return std::any_of(lhs.begin(), lhs.end(), [&rhs](auto id) {
+            return std::find(rhs.begin(), rhs.end(), id) != rhs.end();
+        });
+    };
+
+    return intersects(task.writes, other_task.writes) || 
+        intersects(task.writes, other_task.reads) || 
+        intersects(task.reads, other_task.writes);
+}
+
+void SystemScheduler::runSerial() {
+    for (size_t it{0}; it < this->nodes.size(); it++) {
+        this->runNode(it);
+    }
+}
+
+void SystemScheduler::runParallel() {
+    this->num_completed = 0;
+    for (auto& node : this->nodes) {
+        node.remaining_dependencies = node.num_dependencies;
+    }
+
+    for (size_t it{0}; it < this->nodes.size(); it++) {
+        if (this->nodes[it].num_dependencies == 0) {
+            this->dispatch(it);
+        }
+    }
+
+    // The main thread runs the main thread tasks and otherwise helps the workers
+    while (this->num_completed < this->nodes.size()) {
+        size_t node_index{this->nodes.size()};
+        {
+            std::lock_guard<std::mutex> lock(this->main_thread_mutex);
+            if (!this->main_thread_queue.empty()) {
+                node_index = this->main_thread_queue.back();
+                this->main_thread_queue.pop_back();
+            }
+        }
+
+        if (node_index < this->nodes.size()) {
+            this->runNode(node_index);
+        } else if (!this->thread_pool.runPendingJob()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void SystemScheduler::dispatch(size_t node_index) {
+    if (this->nodes[node_index].task->is_main_thread) {
+        std::lock_guard<std::mutex> lock(this->main_thread_mutex);
+        this->main_thread_queue.push_back(node_index);
+    } else {
+        this->thread_pool.submit([this, node_index]() {
+            this->runNode(node_index);
+        });
+    }
+}
+
+void SystemScheduler::runNode(size_t node_index) {
+    auto& node{this->nodes[node_index]};
+    {
+        DEBUG_TIMER(_, node.task->name);
+        const auto start = std::chrono::steady_clock::now();
+        node.task->run();
+        const auto end = std::chrono::steady_clock::now();
+        node.duration = std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    if (this->parallel) {
+        for (auto dependent : node.dependents) {
+            if (this->nodes[dependent].remaining_dependencies.fetch_sub(1) == 1) {
+                this->dispatch(dependent);
+            }
+        }
+    }
+    this->num_completed++;
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#include <entt/entt.hpp>
+
+#include "system.hpp"
+#include "thread_pool.hpp"
+
+#include "debug_timer.hpp"
+
+// Runs the tasks of a list of systems on the thread pool
+// Systems are added in their serial order. A task depends on every earlier task it conflicts with,
+//  so conflicting tasks keep that order while independent tasks run at the same time
+// Systems which declare no tasks are run as a single exclusive task on the main thread
+class SystemScheduler {
+public:
+    SystemScheduler(entt::registry& registry, ThreadPool& thread_pool);
+
+    void addSystem(System* system);
+    void update();
+
+    // When not parallel the tasks run one after another on the main thread in their serial order
+    void setParallel(bool parallel);
+    bool isParallel();
+
+    // Sum of the task times of the last update, what the update would take serially
+    double getLastSerialTime();
+    double getLastWallTime();
+    // The serial time over the wall time of the last update
+    double getLastSpeedup();
+    double getTotalSerialTime();
+    double getTotalWallTime();
+
+private:
+    struct Node {
+        SystemTask* task;
+        std::vector<size_t> dependents;
+        size_t num_dependencies{0};
+        std::atomic<size_t> remaining_dependencies{0};
+        double duration{0};
+    };
+
+    void buildGraph();
+    static bool isConflicting(const SystemTask& task, const SystemTask& other_task);
+
+    void runSerial();
+    void runParallel();
+    void dispatch(size_t node_index);
+    void runNode(size_t node_index);
+
+    entt::registry& registry;
+    ThreadPool& thread_pool;
+
+    std::vector<System*> systems;
+    // Tasks wrapping the update of systems without tasks, a deque for pointer stability
+    std::deque<SystemTask> wrapper_tasks;
+    std::vector<Node> nodes;
+    bool graph_dirty{true};
+    bool parallel{true};
+
+    std::mutex main_thread_mutex;
+    std::vector<size_t> main_thread_queue;
+    std::atomic<size_t> num_completed{0};
+
+    double last_serial_time{0};
+    double last_wall_time{0};
+    double total_serial_time{0};
+    double total_wall_time{0};
+};
\ No newline at end of file
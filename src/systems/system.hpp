@@ -1,15 +1,78 @@
 #pragma once
 
+#include <vector>
+#include <functional>
+
 #include <entt\entt.hpp>
 
+// Part of a system's update along with the components it touches, used by the SystemScheduler
+//  to decide which tasks can run at the same time
+// Reading or writing a component covers both its values and adding or removing it
+// Anything which could create or destroy entities, run arbitrary callbacks such as state machine
+//  actions, or add and remove components with listeners must be exclusive
+struct SystemTask {
+    const char* name;
+    std::function<void()> run;
+
+    std::vector<entt::id_type> reads;
+    std::vector<entt::id_type> writes;
+    // Storages are created before tasks run in parallel, as creating them modifies the registry
+    std::vector<void(*)(entt::registry&)> storages;
+
+    bool is_exclusive{false};
+    bool is_main_thread{false};
+
+    template<typename... Component>
+    SystemTask& read() {
+        (this->reads.push_back(entt::type_id<Component>().hash()), ...);
+        (this->storages.push_back(+[](entt::registry& registry) { registry.storage<Component>(); }), ...);
+        return *this;
+    }
+
+    template<typename... Component>
+    SystemTask& write() {
+        (this->writes.push_back(entt::type_id<Component>().hash()), ...);
+        (this->storages.push_back(+[](entt::registry& registry) { registry.storage<Component>(); }), ...);
+        return *this;
+    }
+
+    // Nothing else runs at the same time as an exclusive task
+    SystemTask& exclusive() {
+        this->is_exclusive = true;
+        return *this;
+    }
+
+    // Anything which uses the GL context or SDL window must run on the main thread
+    SystemTask& mainThread() {
+        this->is_main_thread = true;
+        return *this;
+    }
+};
+
 class System {
 public:
 
     System(entt::registry& registry) : registry{ registry } {}
+    virtual ~System() = default;
     
-    virtual void update() = 0;
+    // Runs the tasks in the order they were added, systems without tasks override this
+    virtual void update() {
+        for (auto& task : this->tasks) {
+            task.run();
+        }
+    }
+
+    std::vector<SystemTask>& getTasks() {
+        return this->tasks;
+    }
 
 protected:
+    SystemTask& addTask(const char* name, std::function<void()> run) {
+        return this->tasks.emplace_back(name, std::move(run));
+    }
+
     entt::registry& registry;
 
+private:
+    std::vector<SystemTask> tasks;
 };
\ No newline at end of file